@@ -1,18 +1,41 @@
 #include "argparse.hpp"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <algorithm>
-#include <iomanip>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <sstream>
+#include <thread>
+
+#ifndef ARGPARSE_STATS
+/// Set to 0 to compile out instrumentation.
+/// @see ArgParse::Stats
+#define ARGPARSE_STATS 1
+#endif
 
 namespace
 {
 
-const std::string shortDelimiter{"-"};
-const std::string longDelimiter{"--"};
+constexpr std::string_view shortDelimiter{"-"};
+constexpr std::string_view longDelimiter{"--"};
 
 /// @return bool True if @c str begins with @c prefix.
-bool hasPrefix(const std::string &str, const std::string &prefix)
+bool hasPrefix(std::string_view str, std::string_view prefix)
 {
     return str.compare(0, prefix.size(), prefix) == 0;
 }
@@ -27,35 +50,572 @@ std::string to_string(char c)
     return s;
 }
 
-std::vector<std::string> split_on_delimiter(const std::string &str, char delim)
+/// Convert @c arg to a number of type @c T and, if @c target is not null, store it there.
+/// @return Error::Kind Error::Kind::None if the whole of @c arg was converted.
+template <typename T>
+ArgParse::Error::Kind fromChars(std::string_view arg, void *target)
+{
+    T value{};
+    auto last = arg.data() + arg.size();
+    auto [ptr, ec] = std::from_chars(arg.data(), last, value);
+    if (ec == std::errc::result_out_of_range) {
+        return ArgParse::Error::Kind::OutOfRange;
+    }
+    if (ec != std::errc{} || ptr != last) {
+        return ArgParse::Error::Kind::InvalidValue;
+    }
+    if (target) {
+        *static_cast<T *>(target) = value;
+    }
+    return ArgParse::Error::Kind::None;
+}
+
+/// Every option character, as a NUL-terminated string.
+constexpr auto characters = []() {
+    std::array<std::array<char, 2>, 256> table{};
+    for (size_t i = 0; i < table.size(); ++i) {
+        table[i][0] = static_cast<char>(i);
+    }
+    return table;
+}();
+
+/// @return std::string_view View of a static string containing character @c c if non-NUL, otherwise the empty string.
+std::string_view characterName(char c)
+{
+    return {characters[static_cast<unsigned char>(c)].data(), c ? 1u : 0u};
+}
+
+/// @return uint64_t First eight characters of @c str, most significant first, padded with NUL.
+/// @discussion Keys compare as the strings they were made from compare over their first eight characters, so the
+/// characters are compared a word at a time.
+uint64_t prefixKey(std::string_view str)
+{
+    uint64_t key{};
+    for (size_t i = 0; i < sizeof key; ++i) {
+        key = key << CHAR_BIT | (i < str.size() ? static_cast<unsigned char>(str[i]) : 0u);
+    }
+    return key;
+}
+
+/// @brief Bit-parallel edit distance.
+/// @discussion Computes the Levenshtein distance from a pattern of up to 64 characters to each of a series of texts,
+/// with a column of the dynamic programming matrix held as vertical deltas in a pair of words, and computed in a few
+/// word operations from the previous column. Columns are kept, so that a text sharing a prefix with the previous text
+/// resumes from the end of the prefix; texts in sorted order are thus compared as if walking a trie of them.
+/// @see Myers, "A fast bit-vector algorithm for approximate string matching based on dynamic programming", 1999.
+/// @see Hyyrö, "Explaining and extending the bit-parallel approximate string matching algorithm of Myers", 2001.
+class EditDistance
 {
-    std::vector<std::string> result;
-    std::stringstream ss{str};
-    std::string item;
-    while (std::getline(ss, item, delim)) {
-        result.push_back(item);
+public:
+    static constexpr size_t maxPattern = sizeof(uint64_t) * CHAR_BIT;
+
+private:
+    /// Bitmask of the positions in the pattern of each character.
+    std::array<uint64_t, 256> peq_;
+    size_t size_;
+
+    /// Column of the matrix after a number of characters of the text.
+    struct Column {
+        uint64_t vp;
+        uint64_t vn;
+        size_t score;
+    };
+    std::array<Column, 2 * maxPattern + 1> columns_;
+
+    /// Previous text, for whose first @c valid_ characters columns are held.
+    std::string_view text_;
+    size_t valid_;
+
+public:
+    /// @param pattern Non-empty pattern of at most @c maxPattern characters.
+    explicit EditDistance(std::string_view pattern) : peq_{}, size_{pattern.size()}, columns_{}, text_{}, valid_{}
+    {
+        for (size_t i = 0; i < size_; ++i) {
+            peq_[static_cast<unsigned char>(pattern[i])] |= uint64_t{1} << i;
+        }
+        columns_[0] = {~uint64_t{}, 0, size_};
+    }
+
+    /// @param limit Largest distance of interest, less than @c maxPattern.
+    /// @return size_t Edit distance from the pattern to @c text if at most @c limit, otherwise greater than @c limit.
+    size_t operator()(std::string_view text, size_t limit)
+    {
+        auto n = text.size();
+        if ((n > size_ ? n - size_ : size_ - n) > limit) {
+            return limit + 1;
+        }
+
+        auto j = std::min(valid_, n);
+        j = static_cast<size_t>(std::mismatch(text.begin(), text.begin() + j, text_.begin()).first - text.begin());
+        text_ = text;
+
+        auto last = uint64_t{1} << (size_ - 1);
+        for (; j < n; ++j) {
+            auto [vp, vn, score] = columns_[j];
+            auto eq = peq_[static_cast<unsigned char>(text[j])];
+            auto xv = eq | vn;
+            auto xh = (((eq & vp) + vp) ^ vp) | eq;
+            auto ph = vn | ~(xh | vp);
+            auto mh = vp & xh;
+            if (ph & last) {
+                score++;
+            } else if (mh & last) {
+                score--;
+            }
+            ph = ph << 1 | 1;
+            mh <<= 1;
+            columns_[j + 1] = {mh | ~(xv | ph), ph & xv, score};
+
+            // Each remaining character of the text reduces the distance by at most one.
+            if (score > limit + (n - j - 1)) {
+                valid_ = j + 1;
+                return limit + 1;
+            }
+        }
+        valid_ = n;
+        return columns_[n].score;
     }
-    return result;
+};
+
+/// Bits in each word of a bitmask.
+constexpr size_t wordBits = sizeof(uint64_t) * CHAR_BIT;
+
+/// Set bit @c bit of bitmask @c words.
+void setBit(std::pmr::vector<uint64_t> &words, size_t bit)
+{
+    words[bit / wordBits] |= uint64_t{1} << bit % wordBits;
 }
 
+/// @return bool True if bit @c bit of bitmask @c words is set.
+bool testBit(const std::pmr::vector<uint64_t> &words, size_t bit)
+{
+    return words[bit / wordBits] >> bit % wordBits & 1;
+}
+
+/// Base of objects allocated from a memory resource.
+/// @discussion The resource is recorded ahead of each object, so that objects may be deleted by a plain delete
+/// expression, for example by std::unique_ptr.
+class ResourceAllocated
+{
+    /// Prefix of each allocation.
+    struct alignas(std::max_align_t) Header {
+        std::pmr::memory_resource *resource;
+        size_t size;
+    };
+
+public:
+    static void *operator new(size_t size, std::pmr::memory_resource *resource)
+    {
+        size += sizeof(Header);
+        auto header = static_cast<Header *>(resource->allocate(size, alignof(Header)));
+        *header = {resource, size};
+        return header + 1;
+    }
+
+    /// Called if a constructor throws.
+    static void operator delete(void *p, std::pmr::memory_resource *)
+    {
+        operator delete(p);
+    }
+
+    static void operator delete(void *p)
+    {
+        auto header = static_cast<Header *>(p) - 1;
+        header->resource->deallocate(header, header->size, alignof(Header));
+    }
+};
+
+/// Adds the time from its construction to its destruction to a counter, if any.
+class Timer
+{
+    uint64_t *counter_;
+    std::chrono::steady_clock::time_point start_;
+
+public:
+    explicit Timer(uint64_t *counter) : counter_{counter}, start_{}
+    {
+        if (counter_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~Timer()
+    {
+        if (counter_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            *counter_ += static_cast<uint64_t>(nanoseconds);
+        }
+    }
+
+    Timer(const Timer &) = delete;
+    Timer &operator=(const Timer &) = delete;
+};
+
+/// A sequence of arguments, read one at a time.
+class Arguments
+{
+public:
+    virtual ~Arguments() = default;
+
+    /// @return bool False if the arguments are exhausted, otherwise true and @c str views the next argument.
+    virtual bool next(std::string_view &str) = 0;
+
+    /// @return Error The error which exhausted the arguments early, if any.
+    virtual ArgParse::Error error() const
+    {
+        return {};
+    }
+};
+
+/// Arguments held in a vector of strings.
+class VectorArguments : public Arguments
+{
+    std::vector<std::string>::const_iterator it_;
+    std::vector<std::string>::const_iterator end_;
+
+public:
+    explicit VectorArguments(const std::vector<std::string> &argv) : it_{argv.begin()}, end_{argv.end()}
+    {
+    }
+
+    bool next(std::string_view &str) override
+    {
+        if (it_ == end_) {
+            return false;
+        }
+        str = *it_++;
+        return true;
+    }
+};
+
+/// Arguments held in an array of C strings.
+class ArrayArguments : public Arguments
+{
+    char *const *it_;
+    char *const *end_;
+
+public:
+    ArrayArguments(char *const *argv, int argc) : it_{argv}, end_{argv + argc}
+    {
+    }
+
+    bool next(std::string_view &str) override
+    {
+        if (it_ == end_) {
+            return false;
+        }
+        str = *it_++;
+        return true;
+    }
+};
+
+/// A file mapped privately into memory, so that it may be modified in place without changing the file.
+class Mapping : public ResourceAllocated
+{
+    char *data_;
+    size_t size_;
+
+public:
+    Mapping() : data_{}, size_{}
+    {
+    }
+
+    ~Mapping()
+    {
+        if (size_) {
+            munmap(data_, size_);
+        }
+    }
+
+    Mapping(const Mapping &) = delete;
+    Mapping &operator=(const Mapping &) = delete;
+
+    /// Map file @c path.
+    /// @return bool True if successful.
+    bool map(const char *path)
+    {
+        auto fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st {};
+        auto ok = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+        if (ok && st.st_size > 0) {
+            auto size = static_cast<size_t>(st.st_size);
+            auto data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            ok = data != MAP_FAILED;
+            if (ok) {
+                data_ = static_cast<char *>(data);
+                size_ = size;
+            }
+        }
+
+        close(fd);
+        return ok;
+    }
+
+    char *begin() const
+    {
+        return data_;
+    }
+
+    char *end() const
+    {
+        return data_ + size_;
+    }
+};
+
+/// Arguments read from @c base, with each argument of the form "@file" replaced by the arguments in that response file.
+/// @discussion Arguments in a response file are separated by white space. Single and double quotes group characters,
+/// including white space, into one argument, and backslash escapes the following character.
+/// Response files are mapped into memory and tokenized in place as arguments are read, so that each argument is a view
+/// into a mapping; quotes and escapes are removed by moving the remaining characters of the argument down.
+class ResponseFileArguments : public Arguments
+{
+    /// Unread part of a response file.
+    struct Frame {
+        char *cursor;
+        char *end;
+    };
+
+    Arguments &base_;
+    std::pmr::vector<std::unique_ptr<Mapping>> &mappings_;
+    size_t maxDepth_;
+    std::pmr::vector<Frame> frames_;
+    ArgParse::Error error_;
+
+    /// Read next argument from @c frame.
+    /// @return bool False if the response file is exhausted.
+    static bool tokenize(Frame &frame, std::string_view &str)
+    {
+        auto isSpace = [](char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+        };
+
+        auto &cursor = frame.cursor;
+        while (cursor != frame.end && isSpace(*cursor)) {
+            ++cursor;
+        }
+
+        if (cursor == frame.end) {
+            return false;
+        }
+
+        auto begin = cursor;
+        auto out = cursor;
+        char quote{};
+        for (; cursor != frame.end && (quote || !isSpace(*cursor)); ++cursor) {
+            auto c = *cursor;
+            if (c == '\\' && cursor + 1 != frame.end) {
+                c = *++cursor;
+            } else if (quote && c == quote) {
+                quote = '\0';
+                continue;
+            } else if (!quote && (c == '\'' || c == '"')) {
+                quote = c;
+                continue;
+            }
+
+            // Only write once a quote or escape has been removed, so that plain arguments leave pages untouched.
+            if (out != cursor) {
+                *out = c;
+            }
+            ++out;
+        }
+
+        str = std::string_view{begin, static_cast<size_t>(out - begin)};
+        return true;
+    }
+
+public:
+    ResponseFileArguments(Arguments &base, std::pmr::vector<std::unique_ptr<Mapping>> &mappings, size_t maxDepth)
+        : base_{base}, mappings_{mappings}, maxDepth_{maxDepth}, frames_{mappings.get_allocator()}, error_{}
+    {
+    }
+
+    bool next(std::string_view &str) override
+    {
+        while (!error_) {
+            if (frames_.empty()) {
+                if (!base_.next(str)) {
+                    return false;
+                }
+            } else if (!tokenize(frames_.back(), str)) {
+                frames_.pop_back();
+                continue;
+            }
+
+            if (str.size() < 2 || str.front() != '@') {
+                return true;
+            }
+
+            auto path = str.substr(1);
+            if (frames_.size() == maxDepth_) {
+                error_ = ArgParse::Error{ArgParse::Error::Kind::ResponseFileNesting, path};
+                break;
+            }
+
+            auto resource = mappings_.get_allocator().resource();
+            std::unique_ptr<Mapping> mapping{new (resource) Mapping};
+            if (!mapping->map(std::pmr::string{path, resource}.c_str())) {
+                error_ = ArgParse::Error{ArgParse::Error::Kind::UnreadableResponseFile, path};
+                break;
+            }
+
+            frames_.push_back({mapping->begin(), mapping->end()});
+            mappings_.push_back(std::move(mapping));
+        }
+        return false;
+    }
+
+    ArgParse::Error error() const override
+    {
+        return error_;
+    }
+};
+
+/// Destination of operands: a caller's vector, or a vector allocated from a memory resource.
+class Operands
+{
+    std::vector<std::string_view> *vector_;
+    std::pmr::vector<std::string_view> *pmrVector_;
+
+public:
+    explicit Operands(std::vector<std::string_view> &vector) : vector_{&vector}, pmrVector_{}
+    {
+    }
+
+    explicit Operands(std::pmr::vector<std::string_view> &vector) : vector_{}, pmrVector_{&vector}
+    {
+    }
+
+    void push_back(std::string_view str)
+    {
+        if (vector_) {
+            vector_->push_back(str);
+        } else {
+            pmrVector_->push_back(str);
+        }
+    }
+
+    size_t capacity() const
+    {
+        return vector_ ? vector_->capacity() : pmrVector_->capacity();
+    }
+};
+
+/// Records an option found while parsing.
+struct OptionVectorElement {
+    /// Index of the option.
+    size_t index;
+    /// Option-argument, viewing the argument list.
+    std::string_view arg;
+};
+
 } // namespace
 
-class ArgParse::Impl
+/// State of a parse.
+class ArgParse::Context::Impl : public ResourceAllocated
+{
+public:
+    /// Bitmask of the tracked options which were given.
+    std::pmr::vector<uint64_t> given;
+
+    /// Occurrences of each collecting option, in the order the collecting options were added.
+    std::pmr::vector<size_t> counts;
+
+    /// Options found while parsing, in argument order.
+    std::pmr::vector<OptionVectorElement> optv;
+
+    /// Operands found while parsing.
+    std::pmr::vector<std::string_view> operands;
+
+    /// Response files read while parsing, which arguments may view.
+    std::pmr::vector<std::unique_ptr<Mapping>> mappings;
+
+    /// Argument list of the last parse of a std::vector<std::string>, kept if bound variables may view it.
+    std::vector<std::string> arguments;
+
+    /// Positions in @c optv of the first occurrence of each independent option, of the next occurrence of the same
+    /// option, and of the last occurrence of each option so far, while dispatching concurrently.
+    std::pmr::vector<size_t> first;
+    std::pmr::vector<size_t> following;
+    std::pmr::vector<size_t> last;
+
+    /// Threads started to dispatch independent options.
+    std::pmr::vector<std::thread> threads;
+
+    /// Arguments of an incremental parse, if given as an array.
+    std::optional<ArrayArguments> array;
+
+    /// Arguments of an incremental parse with response files expanded, if enabled.
+    std::optional<ResponseFileArguments> expanded;
+
+    /// Arguments being parsed.
+    Arguments *args;
+
+    /// Unparsed options of the current short option cluster.
+    std::string_view cluster;
+
+    /// True once the "--" delimiter has been found.
+    bool delimited;
+
+    /// True once the parse has ended or failed.
+    bool finished;
+
+    /// Error which failed the parse.
+    ArgParse::Error error;
+
+    /// Selected command, which collects the arguments following its name.
+    std::optional<ArgParse> command;
+    std::string_view commandName;
+
+    /// Statistics accumulated by parses, if instrumented.
+    ArgParse::Stats *stats;
+
+    /// @return Stats Statistics to accumulate, or null if not instrumented.
+    ArgParse::Stats *instrumented() const
+    {
+#if ARGPARSE_STATS
+        return stats;
+#else
+        return nullptr;
+#endif
+    }
+
+    explicit Impl(std::pmr::memory_resource *resource)
+        : given{resource}, counts{resource}, optv{resource}, operands{resource}, mappings{resource}, arguments{},
+          first{resource}, following{resource}, last{resource}, threads{resource}, array{}, expanded{}, args{},
+          cluster{}, delimited{}, finished{}, error{}, command{}, commandName{}, stats{}
+    {
+    }
+
+    /// @return memory_resource Resource from which storage is allocated.
+    std::pmr::memory_resource *resource() const
+    {
+        return optv.get_allocator().resource();
+    }
+};
+
+class ArgParse::Impl : public ResourceAllocated
 {
     /// Describes an option.
     struct Option {
-        std::string shortName;
-        std::string longName;
-        std::string parameter;
-        std::string description;
-        std::function<void()> callback;
-        std::function<void(const std::string &)> callback_arg;
-        std::string defaultValue;
+        std::string_view shortName;
+        std::string_view longName;
+        std::string_view parameter;
+        std::string_view description;
+        Callback<void()> callback;
+        Callback<void(const std::string &)> callback_arg;
+        std::string_view defaultValue;
         bool required;
-        bool has;
+        Binding binding;
+        bool independent;
 
-        /// @return std::string Option name, preferring @c longName if available.
-        const std::string &name() const
+        /// @return std::string_view Option name, preferring @c longName if available.
+        std::string_view name() const
         {
             if (longName.size()) {
                 return longName;
@@ -65,375 +625,1760 @@ class ArgParse::Impl
     };
 
     /// The set of supported options.
+    /// @discussion Holds what is needed to describe and dispatch an option; parsing uses only @c longIndex_,
+    /// @c shortIndex_, @c syntax_, @c tracked_, @c required_, @c groups_ and @c collectors_, which are kept compact so
+    /// that lookup in a large table touches little memory.
     /// @see add
-    std::vector<Option> options_;
+    std::pmr::vector<Option> options_;
+
+    /// Entry of @c longIndex_.
+    struct LongEntry {
+        /// @see prefixKey
+        uint64_t key;
+        std::string_view name;
+        size_t index;
+    };
 
-    /// @brief Lookup short name.
-    /// @discussion Find option having short name @c name.
-    std::tuple<Error, Option> lookupShortName(const std::string &name)
+    /// Long names and indices into @c options_, ordered by long name once @c longSorted_.
+    /// @discussion Options sharing a prefix are adjacent, so the options matching an abbreviation form a range which
+    /// is found by binary search. Added options are appended, and the index is sorted before the next lookup, so that
+    /// adding n options costs O(n log n).
+    mutable std::pmr::vector<LongEntry> longIndex_;
+    mutable std::atomic<bool> longSorted_;
+    mutable std::mutex longMutex_;
+    using LongIterator = std::pmr::vector<LongEntry>::const_iterator;
+
+    /// What parsing needs to know of an option.
+    struct Syntax {
+        /// True if the option takes an option-argument.
+        bool parameter;
+        /// Index into @c tracked_ plus one, or zero if whether the option is given is not tracked.
+        size_t tracked;
+        /// Index into @c collectors_ plus one, or zero if the option does not collect its option-arguments.
+        size_t collector;
+    };
+
+    /// Parsing properties of each option, parallel to @c options_.
+    std::pmr::vector<Syntax> syntax_;
+
+    /// Indices into @c options_ of the options which are required or constrained, in the order they were tracked.
+    /// @discussion Each parse records which of them were given in a bitmask, so that constraints are checked a word
+    /// at a time.
+    std::pmr::vector<size_t> tracked_;
+
+    /// Bitmask over @c tracked_ of the required options.
+    std::pmr::vector<uint64_t> required_;
+
+    /// Describes a constraint.
+    struct Group {
+        Constraint constraint;
+        /// Bitmask over @c tracked_ of the options of the group, excluding the first if Constraint::Requires.
+        std::pmr::vector<uint64_t> mask;
+        /// Indices into @c options_ of the options of the group.
+        std::pmr::vector<size_t> options;
+    };
+
+    /// The set of constraints.
+    /// @see constrain
+    std::pmr::vector<Group> groups_;
+
+    /// Indices into @c options_ of the options bound to a vector, in the order they were added.
+    std::pmr::vector<size_t> collectors_;
+
+    /// Number of options bound to a std::string_view or std::vector<std::string_view>, which view the arguments.
+    size_t viewBindings_;
+
+    /// Index into @c options_ plus one for each option character, or zero if the character is not used.
+    /// @discussion If several options share an option character then the first one added is used.
+    std::array<size_t, 256> shortIndex_;
+
+    /// Describes a command.
+    struct Command {
+        std::string_view name;
+        std::string_view description;
+        Callback<void(ArgParse &)> factory;
+    };
+
+    /// The set of supported commands.
+    /// @see addCommand
+    std::pmr::vector<Command> commands_;
+
+    /// Storage of copies of the strings given to add and addCommand.
+    std::pmr::monotonic_buffer_resource strings_;
+
+    /// True if the strings given to add and addCommand are copied, otherwise they are viewed.
+    bool copyStrings_;
+
+    /// @return std::string_view View of @c str, or of a copy of it if @c copyStrings_.
+    std::string_view copy(std::string_view str)
+    {
+        if (!copyStrings_ || str.empty()) {
+            return str;
+        }
+        auto data = static_cast<char *>(strings_.allocate(str.size(), 1));
+        std::copy(str.begin(), str.end(), data);
+        return {data, str.size()};
+    }
+
+    /// Append @c option to the set of supported options and index it.
+    /// @return size_t Index into @c options_.
+    size_t insert(Option option)
+    {
+        auto index = options_.size();
+        options_.push_back(std::move(option));
+        const auto &added = options_.back();
+        auto collects =
+            added.binding.type == Binding::Type::Strings || added.binding.type == Binding::Type::StringViews;
+        syntax_.push_back({!added.parameter.empty(), 0, collects ? collectors_.size() + 1 : 0});
+        if (added.required) {
+            setBit(required_, track(index));
+        }
+        if (collects) {
+            collectors_.push_back(index);
+        }
+        if (added.binding.type == Binding::Type::StringView || added.binding.type == Binding::Type::StringViews) {
+            viewBindings_++;
+        }
+
+        std::lock_guard<std::mutex> lock{helpMutex_};
+        helpValid_ = false;
+
+        if (options_.back().shortName.size()) {
+            auto &slot = shortIndex_[static_cast<unsigned char>(options_.back().shortName.front())];
+            if (!slot) {
+                slot = index + 1;
+            }
+        }
+
+        const auto &name = options_.back().longName;
+        longIndex_.push_back({prefixKey(name), name, index});
+        longSorted_.store(false, std::memory_order_relaxed);
+        return index;
+    }
+
+    /// Sort @c longIndex_, if options have been added since it was last sorted.
+    void sortLongIndex() const
+    {
+        if (longSorted_.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock{longMutex_};
+        if (!longSorted_.load(std::memory_order_relaxed)) {
+            // Of options having the same long name, the first added comes first.
+            std::sort(longIndex_.begin(), longIndex_.end(), [](const LongEntry &a, const LongEntry &b) {
+                auto order = a.name.compare(b.name);
+                return order < 0 || (order == 0 && a.index < b.index);
+            });
+            longSorted_.store(true, std::memory_order_release);
+        }
+    }
+
+    /// @return size_t Index into @c tracked_ of option @c index, which is tracked from now on.
+    size_t track(size_t index)
     {
-        for (auto &option : options_) {
-            if (option.shortName == name) {
-                option.has = true;
-                return {Error{}, option};
+        auto &tracked = syntax_[index].tracked;
+        if (!tracked) {
+            tracked_.push_back(index);
+            tracked = tracked_.size();
+            required_.resize((tracked_.size() + wordBits - 1) / wordBits);
+        }
+        return tracked - 1;
+    }
+
+    /// Number of options marked independent.
+    size_t independent_;
+
+    /// Runs tasks dispatching independent options, or empty to start threads.
+    Executor executor_;
+
+    /// Maximum nesting of response files, or zero if response files are not expanded.
+    size_t responseFileDepth_;
+
+    /// Rendered description, valid if @c helpValid_.
+    mutable std::pmr::string helpCache_;
+    mutable bool helpValid_;
+    mutable std::mutex helpMutex_;
+
+    /// State of a parse made without a caller-owned context.
+    Context context_;
+
+    /// Index returned by a lookup which found no option.
+    static constexpr size_t notFound = SIZE_MAX;
+
+    /// @brief Lookup short name.
+    /// @discussion Find option having option character @c c.
+    /// @return Index into @c options_, or @c notFound.
+    size_t lookupShortName(char c) const
+    {
+        // An empty slot wraps to notFound.
+        return shortIndex_[static_cast<unsigned char>(c)] - 1;
+    }
+
+    /// @return Error Error::Kind::UnrecognizedOption for option character @c c, with any suggestion.
+    Error unrecognizedShortName(char c) const
+    {
+        Error err{Error::Kind::UnrecognizedOption, to_string(c)};
+        err.suggestion = suggestShortName(c);
+        return err;
+    }
+
+    /// @return std::string_view Option character of the other case to @c c, if it is used, otherwise empty.
+    std::string_view suggestShortName(char c) const
+    {
+        auto uc = static_cast<unsigned char>(c);
+        auto other = static_cast<char>(std::islower(uc) ? std::toupper(uc) : std::tolower(uc));
+        if (other != c && shortIndex_[static_cast<unsigned char>(other)]) {
+            return characterName(other);
+        }
+        return {};
+    }
+
+    /// @brief Lookup long name.
+    /// @discussion Find option having long name @c name.
+    /// Unambigious partial matches are supported.
+    /// @return Index into @c options_, or @c notFound.
+    size_t lookupLongName(std::string_view name) const
+    {
+        auto [lower, upper] = prefixRange(name);
+        return upper - lower == 1 ? lower->index : notFound;
+    }
+
+    /// @return Error Error::Kind::AmbiguousOption if more than one long name has prefix @c name, otherwise
+    /// Error::Kind::UnrecognizedOption with any suggestion.
+    Error unrecognizedLongName(std::string_view name) const
+    {
+        auto [lower, upper] = prefixRange(name);
+        if (upper - lower > 1) {
+            return Error{Error::Kind::AmbiguousOption, name};
+        }
+
+        Error err{Error::Kind::UnrecognizedOption, name};
+        err.suggestion = suggestLongName(name);
+        return err;
+    }
+
+    /// @return Range of @c longIndex_ holding the options whose long names have prefix @c name.
+    std::pair<LongIterator, LongIterator> prefixRange(std::string_view name) const
+    {
+        sortLongIndex();
+
+        // Comparing only the first name.size() characters preserves the ordering of longIndex_, so every option
+        // having prefix name lies in [lower, upper). The keys decide most comparisons without reading the names;
+        // only names agreeing with a name of more than eight characters in its first eight are compared in full.
+        auto key = prefixKey(name);
+        auto mask = name.size() < sizeof key ? ~(~uint64_t{} >> name.size() * CHAR_BIT) : ~uint64_t{};
+        auto compare = [&](const LongEntry &e) {
+            auto k = e.key & mask;
+            if (k != key) {
+                return k < key ? -1 : 1;
+            }
+            if (name.size() <= sizeof key) {
+                // A shorter name padded with NUL agrees with a name containing NUL.
+                return e.name.size() < name.size() ? -1 : 0;
+            }
+            return e.name.compare(0, name.size(), name);
+        };
+        auto before = [&](const LongEntry &e, std::string_view) { return compare(e) < 0; };
+        auto after = [&](std::string_view, const LongEntry &e) { return compare(e) > 0; };
+
+        auto lower = std::lower_bound(longIndex_.begin(), longIndex_.end(), name, before);
+        auto upper = std::upper_bound(lower, longIndex_.end(), name, after);
+        return {lower, upper};
+    }
+
+    /// @brief Suggest long name.
+    /// @discussion Find the long name nearest in edit distance to @c name, allowing one edit for each three characters
+    /// of @c name, and at least one and at most three. Of equally near names, the first in order is chosen.
+    /// @return std::string_view Long name, or empty if none is near enough.
+    std::string_view suggestLongName(std::string_view name) const
+    {
+        if (name.empty() || name.size() > EditDistance::maxPattern) {
+            return {};
+        }
+
+        EditDistance distance{name};
+        auto limit = std::clamp<size_t>(name.size() / 3, 1, 3);
+        std::string_view nearest;
+        for (const auto &entry : longIndex_) {
+            if (entry.name.empty()) {
+                continue;
+            }
+            if (auto d = distance(entry.name, limit); d <= limit) {
+                nearest = entry.name;
+                if (d == 1) {
+                    break;
+                }
+                // Only a nearer name may replace this one.
+                limit = d - 1;
+            }
+        }
+        return nearest;
+    }
+
+    /// @brief Convert option-argument.
+    /// @discussion Convert @c arg as described by @c binding and, if @c target is not null, store it there.
+    /// @return Error::Kind Error::Kind::None if @c arg was converted.
+    static Error::Kind convert(const Binding &binding, std::string_view arg, void *target)
+    {
+        switch (binding.type) {
+            case Binding::Type::Int:
+                return fromChars<int>(arg, target);
+            case Binding::Type::Int64:
+                return fromChars<int64_t>(arg, target);
+            case Binding::Type::Double:
+                return fromChars<double>(arg, target);
+            case Binding::Type::Bool: {
+                static const std::pair<std::string_view, bool> names[] = {
+                    {"true", true}, {"false", false}, {"yes", true}, {"no", false},
+                    {"on", true},   {"off", false},   {"1", true},   {"0", false}};
+                for (const auto &[name, value] : names) {
+                    if (arg == name) {
+                        if (target) {
+                            *static_cast<bool *>(target) = value;
+                        }
+                        return Error::Kind::None;
+                    }
+                }
+                return Error::Kind::InvalidValue;
+            }
+            case Binding::Type::StringView:
+                if (target) {
+                    *static_cast<std::string_view *>(target) = arg;
+                }
+                return Error::Kind::None;
+            case Binding::Type::Strings:
+                if (target) {
+                    static_cast<std::vector<std::string> *>(target)->emplace_back(arg);
+                }
+                return Error::Kind::None;
+            case Binding::Type::StringViews:
+                if (target) {
+                    static_cast<std::vector<std::string_view> *>(target)->push_back(arg);
+                }
+                return Error::Kind::None;
+            case Binding::Type::Enum:
+                for (const auto &[name, value] : binding.enumerators) {
+                    if (arg == name) {
+                        if (target) {
+                            binding.assign(target, value);
+                        }
+                        return Error::Kind::None;
+                    }
+                }
+                return Error::Kind::InvalidValue;
+            case Binding::Type::None: // UNREACHABLE
+                break; // UNREACHABLE
+        }
+        return Error::Kind::None; // UNREACHABLE
+    }
+
+    /// @return std::string Rendered description, which is rendered once and cached until options are added.
+    /// @discussion The caller must hold @c helpMutex_.
+    const std::pmr::string &cachedHelp() const
+    {
+        if (!helpValid_) {
+            helpCache_ = renderHelp();
+            helpValid_ = true;
+        }
+        return helpCache_;
+    }
+
+    /// Render description into a single buffer.
+    std::pmr::string renderHelp() const
+    {
+        const std::string_view argumentSeparator{"="};
+        const std::string_view optionSeparator{", "};
+        const std::string_view indent{"  "};
+        const size_t columnSeparatorWidth = 2;
+
+        size_t firstColumnWidth{};
+        for (const auto &option : options_) {
+            if (option.shortName.size()) {
+                size_t w{};
+                if (option.longName.empty()) {
+                    if (option.parameter.size()) {
+                        w = argumentSeparator.size() + option.parameter.size();
+                    }
+                }
+                firstColumnWidth = std::max(firstColumnWidth, shortDelimiter.size() + option.shortName.size() + w);
+            }
+        }
+
+        size_t secondColumnWidth{};
+        for (const auto &option : options_) {
+            if (option.longName.size()) {
+                size_t w{};
+                if (option.parameter.size()) {
+                    w = argumentSeparator.size() + option.parameter.size();
+                }
+                secondColumnWidth = std::max(secondColumnWidth, longDelimiter.size() + option.longName.size() + w);
+            }
+        }
+
+        if (firstColumnWidth && secondColumnWidth) {
+            firstColumnWidth += columnSeparatorWidth;
+        }
+
+        // Continuation lines of a description are aligned with its first line, padded to at least one space.
+        const auto continuationWidth = std::max<size_t>(firstColumnWidth + secondColumnWidth, 1);
+
+        size_t size{};
+        for (const auto &option : options_) {
+            size += indent.size() + firstColumnWidth + secondColumnWidth + indent.size() + option.description.size() +
+                    option.defaultValue.size() + 32;
+            size += static_cast<size_t>(std::count(option.description.begin(), option.description.end(), '\n')) *
+                    (indent.size() + continuationWidth + indent.size());
+        }
+
+        for (const auto &command : commands_) {
+            size += indent.size() + command.name.size() + indent.size() + command.description.size() + 1;
+        }
+
+        std::pmr::string out{resource()};
+        out.reserve(size);
+
+        // Append @c str and pad to @c width.
+        auto column = [&out](size_t width, std::initializer_list<std::string_view> str) {
+            auto start = out.size();
+            for (auto s : str) {
+                out += s;
+            }
+            if (out.size() - start < width) {
+                out.append(width - (out.size() - start), ' ');
+            }
+        };
+
+        // Append the lines of @c description, as split by std::getline: a final empty line is not a line.
+        // Continuation lines are aligned with the first by @c width.
+        auto describe = [&out, &indent](std::string_view description, size_t width) {
+            for (auto first{true}; description.size(); first = false) {
+                auto off = description.find('\n');
+                auto line = description.substr(0, off);
+                description.remove_prefix(off == std::string_view::npos ? description.size() : off + 1);
+
+                if (!first) {
+                    out += '\n';
+                    out += indent;
+                    out.append(width, ' ');
+                }
+                out += indent;
+                out += line;
+            }
+        };
+
+        for (const auto &option : options_) {
+            out += indent;
+
+            if (firstColumnWidth) {
+                if (option.shortName.empty()) {
+                    column(firstColumnWidth, {});
+                } else if (option.longName.size()) {
+                    column(firstColumnWidth, {shortDelimiter, option.shortName, optionSeparator});
+                } else if (option.parameter.size()) {
+                    column(firstColumnWidth, {shortDelimiter, option.shortName, argumentSeparator, option.parameter});
+                } else {
+                    column(firstColumnWidth, {shortDelimiter, option.shortName});
+                }
+            }
+
+            if (secondColumnWidth) {
+                if (option.longName.empty()) {
+                    column(secondColumnWidth, {});
+                } else if (option.parameter.size()) {
+                    column(secondColumnWidth, {longDelimiter, option.longName, argumentSeparator, option.parameter});
+                } else {
+                    column(secondColumnWidth, {longDelimiter, option.longName});
+                }
+            }
+
+            describe(option.description, continuationWidth);
+
+            if (option.required) {
+                out += "  (required)";
+            } else if (option.defaultValue.size()) {
+                out += "  (default: '";
+                out += option.defaultValue;
+                out += "')";
+            }
+
+            out += '\n';
+        }
+
+        if (commands_.size()) {
+            if (options_.size()) {
+                out += '\n';
+            }
+
+            size_t commandWidth{};
+            for (const auto &command : commands_) {
+                commandWidth = std::max(commandWidth, command.name.size());
+            }
+
+            for (const auto &command : commands_) {
+                out += indent;
+                column(commandWidth, {command.name});
+                describe(command.description, commandWidth);
+                out += '\n';
+            }
+        }
+
+        return out;
+    }
+
+public:
+    explicit Impl(std::pmr::memory_resource *resource)
+        : options_{resource}, longIndex_{resource}, longSorted_{true}, longMutex_{}, syntax_{resource},
+          tracked_{resource}, required_{resource}, groups_{resource}, collectors_{resource}, viewBindings_{},
+          shortIndex_{}, commands_{resource}, strings_{resource},
+          copyStrings_{true}, independent_{}, executor_{}, responseFileDepth_{}, helpCache_{resource}, helpValid_{},
+          helpMutex_{}, context_{resource}
+    {
+    }
+
+    /// @return memory_resource Resource from which storage is allocated.
+    std::pmr::memory_resource *resource() const
+    {
+        return options_.get_allocator().resource();
+    }
+
+    /// @return bool True if, once the parse held by @c context returns, bound variables may view its arguments or
+    /// operands may view response files, of this parser or of the command it selected.
+    bool viewsArguments(const Context::Impl &context) const
+    {
+        if (viewBindings_ || context.mappings.size()) {
+            return true;
+        }
+        if (context.command) {
+            auto &impl = *context.command->pimpl;
+            return impl.viewsArguments(*impl.context().pimpl);
+        }
+        return false;
+    }
+
+    Context &context()
+    {
+        return context_;
+    }
+
+    size_t add(char shortName,
+             const char *longName,
+             const char *description,
+             Callback<void()> callback,
+             const char *defaultValue)
+    {
+        return insert({characterName(shortName), copy(longName), copy({}), copy(description),
+                       std::move(callback), {}, copy(defaultValue), {}, {}, {}});
+    }
+
+    size_t add(char shortName,
+             const char *longName,
+             const char *parameter,
+             const char *description,
+             Callback<void(const std::string &)> callback_arg,
+             const char *defaultValue)
+    {
+        return insert({characterName(shortName), copy(longName), copy(parameter), copy(description), {},
+                       std::move(callback_arg), copy(defaultValue), {}, {}, {}});
+    }
+
+    size_t add(char shortName,
+             const char *longName,
+             const char *parameter,
+             const char *description,
+             Callback<void(const std::string &)> callback_arg,
+             bool required)
+    {
+        return insert({characterName(shortName), copy(longName), copy(parameter), copy(description), {},
+                       std::move(callback_arg), copy({}), required, {}, {}});
+    }
+
+    size_t bind(char shortName,
+              const char *longName,
+              const char *parameter,
+              const char *description,
+              Binding binding,
+              const char *defaultValue,
+              bool required)
+    {
+        for (auto &enumerator : binding.enumerators) {
+            enumerator.first = copy(enumerator.first);
+        }
+        return insert({characterName(shortName), copy(longName), copy(parameter), copy(description), {}, {},
+                       copy(defaultValue), required, std::move(binding), {}});
+    }
+
+    void independent(size_t index)
+    {
+        auto &option = options_[index];
+        if (!syntax_[index].collector && !option.independent) {
+            option.independent = true;
+            independent_++;
+        }
+    }
+
+    void executor(Executor executor)
+    {
+        executor_ = std::move(executor);
+    }
+
+    void constrain(Constraint constraint, std::initializer_list<size_t> options)
+    {
+        for (auto index : options) {
+            track(index);
+        }
+
+        Group group{constraint, std::pmr::vector<uint64_t>(required_.size(), resource()),
+                    std::pmr::vector<size_t>{options, resource()}};
+        auto members = options.begin() + (constraint == Constraint::Requires && options.size() ? 1 : 0);
+        for (; members != options.end(); ++members) {
+            setBit(group.mask, syntax_[*members].tracked - 1);
+        }
+        groups_.push_back(std::move(group));
+    }
+
+    void addCommand(const char *name, const char *description, Callback<void(ArgParse &)> factory)
+    {
+        commands_.push_back({copy(name), copy(description), std::move(factory)});
+
+        std::lock_guard<std::mutex> lock{helpMutex_};
+        helpValid_ = false;
+    }
+
+    void copyStrings(bool copy)
+    {
+        copyStrings_ = copy;
+    }
+
+    void expandResponseFiles(size_t maxDepth)
+    {
+        responseFileDepth_ = maxDepth;
+    }
+
+    /// @return std::string Rendered description.
+    std::string help() const
+    {
+        std::lock_guard<std::mutex> lock{helpMutex_};
+        const auto &text = cachedHelp();
+        return {text.data(), text.size()};
+    }
+
+    /// Write rendered description to @c os.
+    void help(std::ostream &os) const
+    {
+        std::lock_guard<std::mutex> lock{helpMutex_};
+        const auto &text = cachedHelp();
+        os.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    /// Write rendered description to file descriptor @c fd.
+    /// @return bool True if the whole description was written.
+    bool help(int fd) const
+    {
+        std::lock_guard<std::mutex> lock{helpMutex_};
+        const auto &text = cachedHelp();
+        size_t written{};
+        while (written < text.size()) {
+            auto n = write(fd, text.data() + written, text.size() - written);
+            if (n < 0 && errno != EINTR) {
+                return false;
+            }
+            written += static_cast<size_t>(std::max<ssize_t>(n, 0));
+        }
+        return true;
+    }
+
+    /// @brief Write completions of argument @c index of @c argv to @c os.
+    /// @see ArgParse::complete
+    void complete(std::ostream &os, int argc, char *const *argv, int index) const
+    {
+        if (index < 0 || index > argc) {
+            return;
+        }
+        std::string_view word{index < argc ? argv[index] : ""};
+
+        // Find what the arguments preceding the one to complete leave it to be.
+        const Option *expecting{};
+        bool delimited{};
+        for (int i = 1; i < index && i < argc; ++i) {
+            std::string_view arg{argv[i]};
+            if (expecting) {
+                expecting = nullptr;
+            } else if (delimited || arg.size() < 2 || arg.front() != '-') {
+                if (delimited || commands_.empty()) {
+                    continue;
+                }
+                auto command = std::find_if(commands_.begin(), commands_.end(), [arg](const Command &c) {
+                    return c.name == arg;
+                });
+                if (command != commands_.end()) {
+                    ArgParse commandParse{resource()};
+                    command->factory(commandParse);
+                    commandParse.pimpl->complete(os, argc - i, argv + i, index - i);
+                }
+                return;
+            } else if (arg == longDelimiter) {
+                delimited = true;
+            } else if (arg.substr(0, longDelimiter.size()) == longDelimiter) {
+                auto n = lookupLongName(arg.substr(longDelimiter.size()));
+                if (n != notFound && syntax_[n].parameter) {
+                    expecting = &options_[n];
+                }
+            } else {
+                // The last option of a cluster expects the next argument, unless the rest of the cluster is its
+                // option-argument.
+                for (size_t j = 1; j < arg.size(); ++j) {
+                    auto n = lookupShortName(arg[j]);
+                    if (n != notFound && syntax_[n].parameter) {
+                        expecting = j + 1 == arg.size() ? &options_[n] : nullptr;
+                        break;
+                    }
+                }
+            }
+        }
+
+        auto line = [&os](std::string_view prefix, std::string_view name, std::string_view description) {
+            os << prefix << name << '\t' << description.substr(0, description.find('\n')) << '\n';
+        };
+        auto longOptions = [&](std::string_view prefix) {
+            auto [lower, upper] = prefixRange(prefix);
+            for (auto it = lower; it != upper; ++it) {
+                if (it->name.size()) {
+                    line(longDelimiter, it->name, options_[it->index].description);
+                }
+            }
+        };
+
+        if (expecting) {
+            line({}, {}, expecting->parameter);
+        } else if (delimited) {
+            return;
+        } else if (word.substr(0, longDelimiter.size()) == longDelimiter) {
+            word.remove_prefix(longDelimiter.size());
+            if (auto off = word.find('='); off != std::string_view::npos) {
+                auto n = lookupLongName(word.substr(0, off));
+                if (n != notFound && syntax_[n].parameter) {
+                    line({}, {}, options_[n].parameter);
+                }
+                return;
+            }
+            longOptions(word);
+        } else if (word == "-") {
+            for (auto slot : shortIndex_) {
+                if (slot) {
+                    line("-", options_[slot - 1].shortName, options_[slot - 1].description);
+                }
+            }
+            longOptions({});
+        } else if (word.size() == 2 && word.front() == '-') {
+            if (auto slot = shortIndex_[static_cast<unsigned char>(word[1])]) {
+                line("-", options_[slot - 1].shortName, options_[slot - 1].description);
+            }
+        } else if (word.empty() || word.front() != '-') {
+            for (const auto &command : commands_) {
+                if (command.name.substr(0, word.size()) == word) {
+                    line({}, command.name, command.description);
+                }
+            }
+        }
+    }
+
+    /// An event, without its error.
+    struct Token {
+        Event::Kind kind;
+        size_t id;
+        std::string_view arg;
+    };
+
+    /// @brief Begin an incremental parse of @c args.
+    /// @discussion Arguments are not copied; option-arguments and operands are views into the arguments, which must
+    /// remain valid until the parse is finished. All state is held in @c context, so parses may run concurrently.
+    void start(Context::Impl &context, Arguments &args) const
+    {
+        context.mappings.clear();
+        context.given.assign(required_.size(), 0);
+        context.counts.assign(collectors_.size(), 0);
+        context.cluster = {};
+        context.delimited = false;
+        context.finished = false;
+        context.args = &args;
+        context.command.reset();
+
+        if (responseFileDepth_) {
+            context.expanded.emplace(args, context.mappings, responseFileDepth_);
+            context.args = &*context.expanded;
+        }
+    }
+
+    /// @brief Parse next argument.
+    /// @discussion If the token is Event::Kind::Error then the error is held in @c context.
+    /// @see ArgParse::Parser::next
+    Token next(Context::Impl &context) const
+    {
+        if (context.finished) {
+            return {Event::Kind::End, {}, {}};
+        }
+
+        auto token = step(context);
+        if (token.kind == Event::Kind::End || token.kind == Event::Kind::Error) {
+            context.finished = true;
+        }
+        return token;
+    }
+
+    /// @brief Parse argument list.
+    /// @discussion Operands are appended to @c operands. Options are collected, and their callbacks are called only
+    /// once the whole argument list has been parsed without error.
+    /// @see ArgParse::process
+    Error process(Context::Impl &context, Arguments &args, Operands operands) const
+    {
+        auto stats = context.instrumented();
+        auto capacity = stats ? allocated(context, operands) : 0;
+        auto before = stats ? *stats : Stats{};
+
+        start(context, args);
+
+        Error err;
+        uint64_t collectNanoseconds{};
+        {
+            Timer timer{stats ? &collectNanoseconds : nullptr};
+            err = collect(context, operands);
+        }
+
+        if (stats) {
+            stats->parses++;
+            stats->bytesAllocated += allocated(context, operands) - capacity;
+            stats->tokenizeNanoseconds += collectNanoseconds - (stats->lookupNanoseconds - before.lookupNanoseconds) -
+                                          (stats->requiredNanoseconds - before.requiredNanoseconds);
+        }
+
+        if (err) {
+            // An error which ended the arguments early takes precedence over its consequences.
+            if (auto argsErr = context.args->error()) {
+                return argsErr;
+            }
+
+            // Leave the arguments which were not processed.
+            for (std::string_view str; context.args->next(str);) {
+                operands.push_back(str);
+            }
+            return err;
+        }
+
+        {
+            Timer timer{stats ? &stats->convertNanoseconds : nullptr};
+            err = validate(context);
+        }
+        if (err) {
+            return err;
+        }
+
+        Timer timer{stats ? &stats->dispatchNanoseconds : nullptr};
+        return dispatch(context);
+    }
+
+    /// @return size_t Bytes of storage held for the state of a parse using @c context, and for @c operands.
+    static size_t allocated(const Context::Impl &context, const Operands &operands)
+    {
+        return context.given.capacity() * sizeof(uint64_t) + context.counts.capacity() * sizeof(size_t) +
+               context.optv.capacity() * sizeof(OptionVectorElement) +
+               context.mappings.capacity() * sizeof(std::unique_ptr<Mapping>) +
+               context.mappings.size() * sizeof(Mapping) + operands.capacity() * sizeof(std::string_view) +
+               (context.first.capacity() + context.following.capacity() + context.last.capacity()) * sizeof(size_t) +
+               context.threads.capacity() * sizeof(std::thread);
+    }
+
+    /// @brief Act on option @c index.
+    /// @discussion Call its callback, or assign its converted option-argument @c arg to its variable.
+    /// @return Error Error::Kind::InvalidValue or Error::Kind::OutOfRange if @c arg could not be converted.
+    Error dispatch(size_t index, std::string_view arg, Stats *stats = nullptr) const
+    {
+        const auto &option = options_[index];
+        if (option.binding.type != Binding::Type::None) {
+            if (auto kind = convert(option.binding, arg, option.binding.target); kind != Error::Kind::None) {
+                return Error{kind, option.name(), arg};
+            }
+        } else if (option.callback) {
+            option.callback();
+        } else {
+            std::string str{arg};
+            if (stats && str.capacity() > std::string{}.capacity()) {
+                stats->bytesAllocated += str.capacity() + 1;
+            }
+            option.callback_arg(str);
+        }
+        return Error{};
+    }
+
+private:
+    /// @brief Collect the options and operands of the arguments of @c context.
+    /// @discussion If commands have been added then the first operand before any "--" selects a command, which
+    /// collects the remaining arguments.
+    Error collect(Context::Impl &context, Operands &operands) const
+    {
+        auto &optv = context.optv;
+        optv.clear();
+
+        for (;;) {
+            auto token = step(context);
+            switch (token.kind) {
+                case Event::Kind::Option:
+                    if (auto stats = context.instrumented()) {
+                        stats->options++;
+                    }
+                    optv.push_back({token.id, token.arg});
+                    break;
+
+                case Event::Kind::Operand:
+                    if (commands_.size() && !context.delimited) {
+                        return select(context, token.arg, operands);
+                    }
+                    if (auto stats = context.instrumented()) {
+                        stats->operands++;
+                    }
+                    operands.push_back(token.arg);
+                    break;
+
+                case Event::Kind::End:
+                    return Error{};
+
+                case Event::Kind::Error:
+                    return std::move(context.error);
+            }
+        }
+    }
+
+    /// @brief Select command @c name.
+    /// @discussion Create the ArgParse of the command, and collect the remaining arguments of @c context with it.
+    Error select(Context::Impl &context, std::string_view name, Operands &operands) const
+    {
+        auto command = std::find_if(commands_.begin(), commands_.end(), [name](const Command &c) {
+            return c.name == name;
+        });
+        if (command == commands_.end()) {
+            return Error{Error::Kind::UnrecognizedCommand, name};
+        }
+
+        if (auto err = checkRequired(context)) {
+            return err;
+        }
+
+        context.commandName = command->name;
+        context.command.emplace(context.resource());
+        command->factory(*context.command);
+
+        auto &impl = *context.command->pimpl;
+        auto &commandContext = *impl.context().pimpl;
+        commandContext.stats = context.stats;
+        impl.start(commandContext, *context.args);
+        return inCommand(impl.collect(commandContext, operands), context.commandName);
+    }
+
+    /// @return Error @c err, if any, attributed to command @c name.
+    static Error inCommand(Error err, std::string_view name)
+    {
+        if (err) {
+            err.command = err.command.empty() ? std::string{name} : std::string{name} + " " + err.command;
+        }
+        return err;
+    }
+
+    /// @return Error First option-argument collected in @c context, or by its command, which cannot be converted.
+    Error validate(const Context::Impl &context) const
+    {
+        for (const auto &member : context.optv) {
+            const auto &option = options_[member.index];
+            if (option.binding.type != Binding::Type::None) {
+                if (auto kind = convert(option.binding, member.arg, nullptr); kind != Error::Kind::None) {
+                    return Error{kind, option.name(), member.arg};
+                }
+            }
+        }
+
+        if (context.command) {
+            auto &impl = *context.command->pimpl;
+            return inCommand(impl.validate(*impl.context().pimpl), context.commandName);
+        }
+
+        return Error{};
+    }
+
+    /// Act on each option collected in @c context, and then on those collected by its command.
+    /// @return Error Error::Kind::CallbackFailed if the callback of an independent option threw.
+    Error dispatch(Context::Impl &context) const
+    {
+        auto stats = context.instrumented();
+        for (size_t i = 0; i < collectors_.size(); ++i) {
+            if (context.counts[i]) {
+                reserve(options_[collectors_[i]].binding, context.counts[i]);
+            }
+        }
+        if (independent_) {
+            if (auto err = dispatchConcurrently(context, stats)) {
+                return err;
+            }
+        } else {
+            for (const auto &member : context.optv) {
+                dispatch(member.index, member.arg, stats);
+            }
+        }
+        if (stats) {
+            stats->dispatched += context.optv.size();
+        }
+
+        if (context.command) {
+            auto &impl = *context.command->pimpl;
+            return inCommand(impl.dispatch(*impl.context().pimpl), context.commandName);
+        }
+        return Error{};
+    }
+
+    /// Independent options of a concurrent dispatch, shared by the threads dispatching them.
+    /// @discussion Each task dispatches every occurrence of one option, in argument order, so that occurrences of an
+    /// option never run concurrently with each other.
+    struct Batch {
+        const Impl &impl;
+        const std::pmr::vector<OptionVectorElement> &optv;
+        /// Position in @c optv of the first occurrence of each independent option given.
+        const std::pmr::vector<size_t> &first;
+        /// Position in @c optv of the next occurrence of the same option, or SIZE_MAX after the last.
+        const std::pmr::vector<size_t> &following;
+
+        /// Position in @c first of the next option to be claimed.
+        std::atomic<size_t> next;
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        /// Tasks which have not finished.
+        size_t running;
+        /// Position in @c optv of the first option whose callback threw, and the error reporting it.
+        size_t failed;
+        Error error;
+
+        /// Dispatch independent options until none remain unclaimed.
+        void work()
+        {
+            for (size_t n; (n = next++) < first.size();) {
+                for (auto i = first[n]; i != SIZE_MAX; i = following[i]) {
+                    const auto &option = impl.options_[optv[i].index];
+                    try {
+                        impl.dispatch(optv[i].index, optv[i].arg);
+                    } catch (const std::exception &e) {
+                        fail(i, Error{Error::Kind::CallbackFailed, option.name(), e.what()});
+                        break;
+                    } catch (...) {
+                        fail(i, Error{Error::Kind::CallbackFailed, option.name()});
+                        break;
+                    }
+                }
             }
         }
 
-        return {Error{Error::Kind::UnrecognizedOption, name}, {}};
-    }
+        /// Record that the option at position @c i of @c optv failed with @c err.
+        void fail(size_t i, Error err)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (i < failed) {
+                failed = i;
+                error = std::move(err);
+            }
+        }
+    };
 
-    /// @brief Lookup long name.
-    /// @discussion Find option having long name @c name.
-    /// Unambigious partial matches are supported.
-    std::tuple<Error, Option> lookupLongName(const std::string &name)
+    /// @brief Act on each option collected in @c context, dispatching independent options concurrently.
+    /// @discussion Other options are dispatched in order on this thread, which then helps with the independent
+    /// options. An exception thrown by the callback of another option propagates once every task has finished.
+    /// @return Error Error::Kind::CallbackFailed if the callback of an independent option threw.
+    Error dispatchConcurrently(Context::Impl &context, Stats *stats) const
     {
-        int n{};
-        for (const auto &option : options_) {
-            if (hasPrefix(option.longName, name)) {
-                n++;
+        // Chain the occurrences of each independent option, which are then dispatched by a single task.
+        const auto &optv = context.optv;
+        auto &first = context.first;
+        auto &following = context.following;
+        auto &last = context.last;
+        first.clear();
+        following.assign(optv.size(), SIZE_MAX);
+        last.assign(options_.size(), SIZE_MAX);
+        for (size_t i = 0; i < optv.size(); ++i) {
+            auto index = optv[i].index;
+            if (options_[index].independent) {
+                if (last[index] == SIZE_MAX) {
+                    first.push_back(i);
+                } else {
+                    following[last[index]] = i;
+                }
+                last[index] = i;
             }
         }
-
-        if (n > 1) {
-            return {Error{Error::Kind::AmbiguousOption, name}, {}};
+        auto count = first.size();
+
+        // Callbacks of independent options typically wait on I/O, so use at least a few threads.
+        auto helpers = std::min<size_t>(count, std::max(std::thread::hardware_concurrency(), 4u)) - (count ? 1 : 0);
+        Batch batch{*this, optv, first, following, {0}, {}, {}, helpers, SIZE_MAX, {}};
+
+        auto &threads = context.threads;
+        for (size_t i = 0; i < helpers; ++i) {
+            auto task = [&batch]() {
+                batch.work();
+                std::lock_guard<std::mutex> lock{batch.mutex};
+                batch.running--;
+                batch.finished.notify_all();
+            };
+            try {
+                if (executor_) {
+                    executor_(task);
+                } else {
+                    threads.emplace_back(task);
+                }
+            } catch (...) {
+                // This thread dispatches the options the remaining tasks would have.
+                std::lock_guard<std::mutex> lock{batch.mutex};
+                batch.running -= helpers - i;
+                break;
+            }
         }
 
-        if (n == 1) {
-            for (auto &option : options_) {
-                if (hasPrefix(option.longName, name)) {
-                    option.has = true;
-                    return {Error{}, option};
-                }
+        auto wait = [&]() {
+            batch.work();
+            std::unique_lock<std::mutex> lock{batch.mutex};
+            batch.finished.wait(lock, [&batch]() { return !batch.running; });
+            lock.unlock();
+            for (auto &thread : threads) {
+                thread.join();
             }
-        } // UNREACHABLE
+            threads.clear();
+        };
 
-        return {Error{Error::Kind::UnrecognizedOption, name}, {}};
+        try {
+            for (const auto &member : optv) {
+                if (!options_[member.index].independent) {
+                    dispatch(member.index, member.arg, stats);
+                }
+            }
+        } catch (...) {
+            wait();
+            throw;
+        }
+        wait();
+        return std::move(batch.error);
     }
 
-public:
-    Impl() : options_{}
+    /// Reserve room for @c count more option-arguments in the vector bound by @c binding.
+    static void reserve(const Binding &binding, size_t count)
     {
+        if (binding.type == Binding::Type::Strings) {
+            auto &values = *static_cast<std::vector<std::string> *>(binding.target);
+            values.reserve(values.size() + count);
+        } else {
+            auto &values = *static_cast<std::vector<std::string_view> *>(binding.target);
+            values.reserve(values.size() + count);
+        }
     }
 
-    void add(char shortName,
-             const char *longName,
-             const char *description,
-             std::function<void()> callback,
-             const char *defaultValue)
+    /// @return Error Error::Kind::MissingOption if a required option was not given, otherwise the first constraint
+    /// which was not met.
+    Error checkRequired(const Context::Impl &context) const
     {
-        options_.push_back({to_string(shortName), longName, {}, description, callback, {}, defaultValue, {}, {}});
-    }
+        auto stats = context.instrumented();
+        Timer timer{stats ? &stats->requiredNanoseconds : nullptr};
+        for (size_t w = 0; w < required_.size(); ++w) {
+            if (auto missing = required_[w] & ~context.given[w]) {
+                auto bit = w * wordBits;
+                for (; !(missing & 1); missing >>= 1) {
+                    bit++;
+                }
+                return Error{Error::Kind::MissingOption, options_[tracked_[bit]].name()};
+            }
+        }
 
-    void add(char shortName,
-             const char *longName,
-             const char *parameter,
-             const char *description,
-             std::function<void(const std::string &)> callback_arg,
-             const char *defaultValue)
-    {
-        options_.push_back(
-            {to_string(shortName), longName, parameter, description, {}, callback_arg, defaultValue, {}, {}});
+        for (const auto &group : groups_) {
+            if (auto err = check(context, group)) {
+                return err;
+            }
+        }
+        return Error{};
     }
 
-    void add(char shortName,
-             const char *longName,
-             const char *parameter,
-             const char *description,
-             std::function<void(const std::string &)> callback_arg,
-             bool required)
+    /// @return bool True if option @c index, which is tracked, was given.
+    bool given(const Context::Impl &context, size_t index) const
     {
-        options_.push_back(
-            {to_string(shortName), longName, parameter, description, {}, callback_arg, {}, required, {}});
+        return testBit(context.given, syntax_[index].tracked - 1);
     }
 
-    void help() const
+    /// @return Error Error describing how the options given fail constraint @c group, if they do.
+    Error check(const Context::Impl &context, const Group &group) const
     {
-        const std::string argumentSeparator{"="};
-        const size_t columnSeparatorWidth = 2;
-
-        size_t firstColumnWidth{};
-        for (const auto &option : options_) {
-            if (option.shortName.size()) {
-                size_t w{};
-                if (option.longName.empty()) {
-                    if (option.parameter.size()) {
-                        w = argumentSeparator.size() + option.parameter.size();
-                    }
-                }
-                firstColumnWidth = std::max(firstColumnWidth, shortDelimiter.size() + option.shortName.size() + w);
-            }
+        // Count the options of the group which were given, up to two, and whether all of them were.
+        size_t count{};
+        bool all{true};
+        for (size_t w = 0; w < group.mask.size(); ++w) {
+            auto bits = group.mask[w] & context.given[w];
+            count += bits ? (bits & (bits - 1) ? 2 : 1) : 0;
+            all = all && bits == group.mask[w];
         }
 
-        size_t secondColumnWidth{};
-        for (const auto &option : options_) {
-            if (option.longName.size()) {
-                size_t w{};
-                if (option.parameter.size()) {
-                    w = argumentSeparator.size() + option.parameter.size();
+        switch (group.constraint) {
+            case Constraint::ExactlyOne:
+                if (!count) {
+                    std::string names;
+                    for (auto index : group.options) {
+                        names += (names.empty() ? "" : "|") + std::string{options_[index].name()};
+                    }
+                    return Error{Error::Kind::MissingOneOf, names};
                 }
-                secondColumnWidth = std::max(secondColumnWidth, longDelimiter.size() + option.longName.size() + w);
-            }
-        }
-
-        if (firstColumnWidth && secondColumnWidth) {
-            firstColumnWidth += columnSeparatorWidth;
-        }
-
-        for (const auto &option : options_) {
-            // Indent.
-            std::cout << "  ";
-
-            if (firstColumnWidth) {
-                std::stringstream ss;
-                if (option.shortName.size()) {
-                    ss << shortDelimiter << option.shortName;
-                    if (option.longName.empty()) {
-                        if (option.parameter.size()) {
-                            ss << argumentSeparator << option.parameter;
+                [[fallthrough]];
+            case Constraint::AtMostOne:
+                if (count > 1) {
+                    std::string_view names[2];
+                    size_t n{};
+                    for (auto index : group.options) {
+                        if (n < 2 && given(context, index)) {
+                            names[n++] = options_[index].name();
                         }
-                    } else {
-                        ss << ", ";
                     }
+                    Error err{Error::Kind::ConflictingOptions, names[0]};
+                    err.other = names[1];
+                    return err;
                 }
-                std::cout << std::left << std::setw(static_cast<int>(firstColumnWidth)) << ss.str();
-            }
-
-            if (secondColumnWidth) {
-                std::stringstream ss;
-                if (option.longName.size()) {
-                    ss << longDelimiter << option.longName;
-                    if (option.parameter.size()) {
-                        ss << argumentSeparator << option.parameter;
+                break;
+            case Constraint::Requires:
+                if (!all && given(context, group.options.front())) {
+                    for (auto index : group.options) {
+                        if (!given(context, index)) {
+                            Error err{Error::Kind::MissingDependency, options_[group.options.front()].name()};
+                            err.other = options_[index].name();
+                            return err;
+                        }
                     }
                 }
-                std::cout << std::left << std::setw(static_cast<int>(secondColumnWidth)) << ss.str();
-            }
-
-            if (option.description.size()) {
-                auto first{true};
-                for (const auto &line : split_on_delimiter(option.description, '\n')) {
-                    if (first) {
-                        first = false;
-                    } else {
-                        std::cout << std::endl << "  " << std::setw(static_cast<int>(firstColumnWidth + secondColumnWidth)) << " ";
-                    }
-                    std::cout << "  " << line;
-		}
-            }
+                break;
+        }
+        return Error{};
+    }
 
-            if (option.required) {
-                std::cout << "  (required)";
-            } else if (option.defaultValue.size()) {
-                std::cout << "  (default: '" << option.defaultValue << "')";
-            }
+    /// @return Token Error token, holding @c err in @c context.
+    static Token failure(Context::Impl &context, Error err)
+    {
+        context.error = std::move(err);
+        return {Event::Kind::Error, {}, {}};
+    }
 
-            std::cout << std::endl;
+    /// @return Token Option token for option @c index, which was given with option-argument @c arg.
+    Token found(Context::Impl &context, size_t index, std::string_view arg) const
+    {
+        const auto &syntax = syntax_[index];
+        if (syntax.tracked) {
+            setBit(context.given, syntax.tracked - 1);
         }
+        if (syntax.collector) {
+            context.counts[syntax.collector - 1]++;
+        }
+        return {Event::Kind::Option, index, arg};
     }
 
-    Error process(std::vector<std::string> &argv)
+    Token step(Context::Impl &context) const
     {
-        for (auto &option : options_) {
-            option.has = false;
+        if (context.cluster.size()) {
+            return stepShort(context);
         }
 
-        struct OptionVectorElement {
-            Option option;
-            std::string arg;
-        };
-
-        std::vector<OptionVectorElement> optv;
-
-        for (auto it = argv.begin(); it != argv.end();) {
-            auto str{*it};
+        auto &args = *context.args;
 
+        std::string_view str;
+        while (args.next(str)) {
             // §4 All options should be preceded by the '-' delimiter character.
             // §9 All options should precede operands on the command line.
-            if (!hasPrefix(str, shortDelimiter)) {
+            if (context.delimited || !hasPrefix(str, shortDelimiter)) {
                 // Extension: allow mixing of options and non-options.
-                it++;
-                continue;
+                return {Event::Kind::Operand, {}, str};
             }
 
-            it = argv.erase(it);
-
             // §10 The first -- argument that is not an option-argument should be accepted as a delimiter indicating the
             // end of options.
             if (str == longDelimiter) {
-                break;
+                context.delimited = true;
+                continue;
             }
 
             if (hasPrefix(str, longDelimiter)) {
-                // Extension: Long options begin with the '--' delimiter string.
-                str.erase(str.begin(), str.begin() + static_cast<int>(longDelimiter.size()));
-
-                std::string split{"="};
-                std::string arg{};
-
-                auto off = str.find(split);
-                auto hasParameter = off != std::string::npos;
-                if (hasParameter) {
-                    arg = str.substr(off + split.size());
-                    str = str.substr(0, off);
-                }
-
-                auto [err, option] = lookupLongName(str);
-                if (err) {
-                    return err;
+                return stepLong(context, str.substr(longDelimiter.size()));
+            }
 
-                } else if (option.parameter.size()) {
-                    // §7 Option-arguments should not be optional.
-                    if (hasParameter) {
-                        optv.push_back({option, arg});
+            // §4 All options should be preceded by the '-' delimiter character.
+            str.remove_prefix(shortDelimiter.size());
 
-                    } else if (it != argv.end()) {
-                        optv.push_back({option, *it});
-                        it = argv.erase(it);
+            // §5 One or more options without option-arguments, followed by at most one option that takes an
+            // option-argument, should be accepted when grouped behind one '-' delimiter.
+            if (str.empty()) {
+                return failure(context, Error{Error::Kind::InvalidOption, ""});
+            }
 
-                    } else {
-                        return Error{Error::Kind::RequiresArgument, option.longName};
-                    }
+            context.cluster = str;
+            return stepShort(context);
+        }
 
-                } else if (hasParameter) {
-                    return Error{Error::Kind::UnexpectedArgument, option.longName};
+        if (auto err = args.error()) {
+            return failure(context, std::move(err));
+        }
 
-                } else {
-                    optv.push_back({option, ""});
-                }
+        if (auto err = checkRequired(context)) {
+            return failure(context, std::move(err));
+        }
 
-            } else {
-                // §4 All options should be preceded by the '-' delimiter character.
-                str.erase(str.begin());
+        return {Event::Kind::End, {}, {}};
+    }
 
-                // §5 One or more options without option-arguments, followed by at most one option that takes an
-                // option-argument, should be accepted when grouped behind one '-' delimiter.
-                if (str.empty()) {
-                    return Error{Error::Kind::InvalidOption, ""};
-                }
+    /// Parse long option @c str, without its delimiter.
+    Token stepLong(Context::Impl &context, std::string_view str) const
+    {
+        // Extension: Long options begin with the '--' delimiter string.
+        std::string_view split{"="};
+        std::string_view arg{};
+
+        auto off = str.find(split);
+        auto hasParameter = off != std::string_view::npos;
+        if (hasParameter) {
+            arg = str.substr(off + split.size());
+            str = str.substr(0, off);
+        }
 
-                while (!str.empty()) {
-                    std::string name = {str.front()};
-                    str.erase(str.begin());
+        size_t index;
+        {
+            auto stats = context.instrumented();
+            Timer timer{stats ? &stats->lookupNanoseconds : nullptr};
+            if (stats) {
+                stats->longLookups++;
+            }
+            index = lookupLongName(str);
+        }
+        if (index == notFound) {
+            return failure(context, unrecognizedLongName(str));
+        }
 
-                    auto [err, option] = lookupShortName(name);
-                    if (err) {
-                        return err;
+        if (syntax_[index].parameter) {
+            // §7 Option-arguments should not be optional.
+            if (hasParameter || context.args->next(arg)) {
+                return found(context, index, arg);
+            }
+            return failure(context, Error{Error::Kind::RequiresArgument, options_[index].longName});
+        }
 
-                    } else if (option.parameter.size()) {
-                        if (str.size()) {
-                            optv.push_back({option, str});
+        if (hasParameter) {
+            return failure(context, Error{Error::Kind::UnexpectedArgument, options_[index].longName});
+        }
 
-                        } else if (it != argv.end()) {
-                            optv.push_back({option, *it});
-                            it = argv.erase(it);
+        return found(context, index, {});
+    }
 
-                        } else {
-                            return Error{Error::Kind::RequiresArgument, name};
-                        }
-                        break;
-                    }
+    /// Parse the next option of the current short option cluster.
+    Token stepShort(Context::Impl &context) const
+    {
+        auto c = context.cluster.front();
+        context.cluster.remove_prefix(1);
 
-                    optv.push_back({option, ""});
-                }
+        size_t index;
+        {
+            auto stats = context.instrumented();
+            Timer timer{stats ? &stats->lookupNanoseconds : nullptr};
+            if (stats) {
+                stats->shortLookups++;
             }
+            index = lookupShortName(c);
         }
-
-        for (const auto &option : options_) {
-            if (option.required && !option.has) {
-                return Error{Error::Kind::MissingOption, option.name()};
-            }
+        if (index == notFound) {
+            return failure(context, unrecognizedShortName(c));
         }
 
-        for (const auto &member : optv) {
-            if (member.option.callback) {
-                member.option.callback();
-            } else {
-                member.option.callback_arg(member.arg);
+        if (syntax_[index].parameter) {
+            std::string_view arg{};
+            if (context.cluster.size()) {
+                arg = context.cluster;
+                context.cluster = {};
+
+            } else if (!context.args->next(arg)) {
+                return failure(context, Error{Error::Kind::RequiresArgument, to_string(c)});
             }
+
+            return found(context, index, arg);
         }
 
-        return Error{};
+        return found(context, index, {});
     }
 };
 
-ArgParse::Error::Error() : ArgParse::Error{Error::Kind::None, ""}
+ArgParse::Error::Error() : kind{Error::Kind::None}, name{}, value{}, other{}, command{}, suggestion{}
+{
+}
+
+ArgParse::Error::Error(Error::Kind _kind, std::string_view _name, std::string_view _value)
+    : kind{_kind}, name{_name}, value{_value}, other{}, command{}, suggestion{}
+{
+}
+
+ArgParse::Error::operator bool() const
 {
+    return kind != Error::Kind::None;
 }
 
-ArgParse::Error::Error(Error::Kind _kind, const std::string &name) : kind{_kind}, message{}
+std::string ArgParse::Error::message() const
 {
     std::stringstream ss;
+    format(ss);
+    return ss.str();
+}
+
+void ArgParse::Error::format(std::ostream &os) const
+{
     switch (kind) {
         case Error::Kind::None:
             break;
         case Error::Kind::InvalidOption:
-            ss << "invalid option '" << name << "'";
+            os << "invalid option '" << name << "'";
             break;
         case Error::Kind::AmbiguousOption:
-            ss << "option '" << name << "' is ambiguous";
+            os << "option '" << name << "' is ambiguous";
             break;
         case Error::Kind::UnrecognizedOption:
-            ss << "unrecognized option '" << name << "'";
+            os << "unrecognized option '" << name << "'";
+            if (suggestion.size()) {
+                os << "; did you mean '" << suggestion << "'?";
+            }
             break;
         case Error::Kind::RequiresArgument:
-            ss << "option '" << name << "' requires an argument";
+            os << "option '" << name << "' requires an argument";
             break;
         case Error::Kind::UnexpectedArgument:
-            ss << "option '" << name << "' does not allow an argument";
+            os << "option '" << name << "' does not allow an argument";
             break;
         case Error::Kind::MissingOption:
-            ss << "missing required option '" << name << "'";
+            os << "missing required option '" << name << "'";
+            break;
+        case Error::Kind::UnreadableResponseFile:
+            os << "cannot read response file '" << name << "'";
+            break;
+        case Error::Kind::ResponseFileNesting:
+            os << "response file '" << name << "' is nested too deeply";
+            break;
+        case Error::Kind::InvalidValue:
+            os << "invalid value '" << value << "' for option '" << name << "'";
+            break;
+        case Error::Kind::OutOfRange:
+            os << "value '" << value << "' for option '" << name << "' is out of range";
+            break;
+        case Error::Kind::UnrecognizedCommand:
+            os << "unrecognized command '" << name << "'";
+            break;
+        case Error::Kind::ConflictingOptions:
+            os << "options '" << name << "' and '" << other << "' cannot be used together";
+            break;
+        case Error::Kind::MissingOneOf:
+            os << "missing one of options '" << name << "'";
+            break;
+        case Error::Kind::MissingDependency:
+            os << "option '" << name << "' requires option '" << other << "'";
+            break;
+        case Error::Kind::CallbackFailed:
+            os << "option '" << name << "' failed";
+            if (value.size()) {
+                os << ": " << value;
+            }
             break;
     }
-    message = ss.str();
 }
 
-ArgParse::Error::operator bool() const
+ArgParse::ArgParse() : ArgParse{std::pmr::get_default_resource()}
 {
-    return kind != Error::Kind::None;
 }
 
-ArgParse::ArgParse() : pimpl{std::make_unique<Impl>()}
+ArgParse::ArgParse(std::pmr::memory_resource *resource) : pimpl{new (resource) Impl{resource}}
 {
 }
 
 ArgParse::~ArgParse() = default;
 
-void ArgParse::add(char shortName,
+size_t ArgParse::add(char shortName,
                    const char *longName,
                    const char *description,
-                   std::function<void()> callback,
+                   Callback<void()> callback,
                    const char *defaultValue)
 {
-    pimpl->add(shortName, longName, description, callback, defaultValue);
+    return pimpl->add(shortName, longName, description, std::move(callback), defaultValue);
 }
 
-void ArgParse::add(char shortName,
+size_t ArgParse::add(char shortName,
                    const char *longName,
                    const char *parameter,
                    const char *description,
-                   std::function<void(const std::string &)> callback,
+                   Callback<void(const std::string &)> callback,
                    const char *defaultValue)
 {
-    pimpl->add(shortName, longName, parameter, description, callback, defaultValue);
+    return pimpl->add(shortName, longName, parameter, description, std::move(callback), defaultValue);
 }
 
-void ArgParse::add(char shortName,
+size_t ArgParse::add(char shortName,
                    const char *longName,
                    const char *parameter,
                    const char *description,
-                   std::function<void(const std::string &)> callback,
+                   Callback<void(const std::string &)> callback,
                    bool required)
 {
-    pimpl->add(shortName, longName, parameter, description, callback, required);
+    return pimpl->add(shortName, longName, parameter, description, std::move(callback), required);
+}
+
+size_t ArgParse::bind(char shortName,
+                    const char *longName,
+                    const char *parameter,
+                    const char *description,
+                    Binding binding,
+                    const char *defaultValue,
+                    bool required)
+{
+    return pimpl->bind(shortName, longName, parameter, description, std::move(binding), defaultValue, required);
+}
+
+std::pmr::memory_resource *ArgParse::resource() const
+{
+    return pimpl->resource();
+}
+
+void ArgParse::independent(size_t id)
+{
+    pimpl->independent(id);
+}
+
+void ArgParse::executor(Executor executor)
+{
+    pimpl->executor(std::move(executor));
+}
+
+void ArgParse::constrain(Constraint constraint, std::initializer_list<size_t> options)
+{
+    pimpl->constrain(constraint, options);
+}
+
+void ArgParse::addCommand(const char *name, const char *description, Callback<void(ArgParse &)> factory)
+{
+    pimpl->addCommand(name, description, std::move(factory));
+}
+
+ArgParse::Parser::Parser(const ArgParse &argParse, Context &context, int argc, char *const *argv)
+    : argParse_{argParse}, context_{context}
+{
+    auto &array = context_.pimpl->array.emplace(argv + 1, std::max(argc - 1, 0));
+    argParse_.pimpl->start(*context_.pimpl, array);
+}
+
+ArgParse::Event ArgParse::Parser::next()
+{
+    auto token = argParse_.pimpl->next(*context_.pimpl);
+    if (token.kind == Event::Kind::Error) {
+        return {token.kind, token.id, token.arg, std::move(context_.pimpl->error)};
+    }
+    return {token.kind, token.id, token.arg, {}};
+}
+
+ArgParse::Error ArgParse::dispatch(const Event &event) const
+{
+    if (event.kind != Event::Kind::Option) {
+        return Error{};
+    }
+    return pimpl->dispatch(event.id, event.arg);
+}
+
+void ArgParse::copyStrings(bool copy)
+{
+    pimpl->copyStrings(copy);
+}
+
+void ArgParse::expandResponseFiles(size_t maxDepth)
+{
+    pimpl->expandResponseFiles(maxDepth);
 }
 
 void ArgParse::help() const
 {
-    pimpl->help();
+    help(std::cout);
+    std::cout.flush();
+}
+
+void ArgParse::help(std::ostream &os) const
+{
+    pimpl->help(os);
+}
+
+void ArgParse::complete(std::ostream &os, int argc, char *const *argv, int index) const
+{
+    pimpl->complete(os, argc, argv, index);
+}
+
+void ArgParse::completionScript(std::ostream &os, Shell shell, std::string_view program)
+{
+    // Each script runs the program with the words typed so far and ARGPARSE_COMPLETE holding the index of the word to
+    // complete. A line holding only a tab and a parameter name means an option-argument is expected, and files are
+    // completed instead, as they are when there are no completions.
+    static const char *const scripts[] = {
+        R"(# bash completion for @PROGRAM@
+@FUNCTION@() {
+    local line=${COMP_LINE:0:COMP_POINT} words candidate
+    read -ra words <<< "$line"
+    [[ -z $line || $line == *[[:space:]] ]] && words+=("")
+    COMPREPLY=()
+    while IFS= read -r candidate; do
+        candidate=${candidate%%$'\t'*}
+        [[ -n $candidate ]] && COMPREPLY+=("$candidate")
+    done < <(ARGPARSE_COMPLETE=$((${#words[@]} - 1)) "${words[@]}" 2>/dev/null)
+    (( ${#COMPREPLY[@]} )) || compopt -o default
+}
+complete -F @FUNCTION@ @PROGRAM@
+)",
+        R"(#compdef @PROGRAM@
+@FUNCTION@() {
+    local -a lines described
+    local line
+    lines=("${(@f)$(ARGPARSE_COMPLETE=$((CURRENT - 1)) "${(@)words[1,CURRENT]}" 2>/dev/null)}")
+    for line in "${lines[@]}"; do
+        [[ -n $line ]] || continue
+        if [[ -z ${line%%$'\t'*} ]]; then
+            _message "${line#*$'\t'}"
+            _files
+            return
+        fi
+        described+=("${${line%%$'\t'*}//:/\\:}:${line#*$'\t'}")
+    done
+    if (( ${#described} )); then
+        _describe option described
+    else
+        _files
+    fi
+}
+compdef @FUNCTION@ @PROGRAM@
+)",
+        R"(# fish completion for @PROGRAM@
+function @FUNCTION@
+    set -l current (commandline -ct)
+    set -l tokens (commandline -opc) "$current"
+    set -l lines (env ARGPARSE_COMPLETE=(math (count $tokens) - 1) $tokens 2>/dev/null)
+    if not set -q lines[1]; or string match -q -- \t'*' $lines[1]
+        __fish_complete_path "$current"
+    else
+        printf '%s\n' $lines
+    end
+end
+complete -c @PROGRAM@ -f -a '(@FUNCTION@)'
+)"};
+
+    std::string function{"_"};
+    for (auto c : program) {
+        function += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    function += "_argparse";
+
+    std::string script{scripts[static_cast<size_t>(shell)]};
+    for (auto [placeholder, value] : {std::pair<std::string_view, std::string_view>{"@PROGRAM@", program},
+                                      std::pair<std::string_view, std::string_view>{"@FUNCTION@", function}}) {
+        for (size_t off{}; (off = script.find(placeholder, off)) != std::string::npos; off += value.size()) {
+            script.replace(off, placeholder.size(), value);
+        }
+    }
+    os << script;
+}
+
+bool ArgParse::help(int fd) const
+{
+    return pimpl->help(fd);
+}
+
+std::string ArgParse::helpText() const
+{
+    return pimpl->help();
 }
 
 ArgParse::Error ArgParse::process(std::vector<std::string> &argv)
 {
-    return pimpl->process(argv);
+    return process(pimpl->context(), argv);
+}
+
+ArgParse::Error ArgParse::process(int argc, char *const *argv, std::vector<std::string_view> &operands)
+{
+    return process(pimpl->context(), argc, argv, operands);
+}
+
+ArgParse::Error ArgParse::process(Context &context, std::vector<std::string> &argv) const
+{
+    VectorArguments args{argv};
+
+    auto &operands = context.pimpl->operands;
+    operands.clear();
+    auto err = pimpl->process(*context.pimpl, args, Operands{operands});
+
+    if (pimpl->viewsArguments(*context.pimpl)) {
+        // Keep the arguments in the context until its next parse, and return copies of the operands. The arguments of
+        // the previous parse are reused as storage for the copies.
+        std::swap(argv, context.pimpl->arguments);
+        argv.assign(operands.begin(), operands.end());
+        return err;
+    }
+
+    // Operands view a subsequence of argv, so compact argv in place in a single pass keeping the arguments that
+    // operands refer to.
+    auto out = argv.begin();
+    auto operand = operands.begin();
+    for (auto it = argv.begin(); it != argv.end() && operand != operands.end(); ++it) {
+        if (operand->data() == it->data()) {
+            ++operand;
+            if (out != it) {
+                *out = std::move(*it);
+            }
+            ++out;
+        }
+    }
+    argv.erase(out, argv.end());
+
+    return err;
+}
+
+ArgParse::Error
+ArgParse::process(Context &context, int argc, char *const *argv, std::vector<std::string_view> &operands) const
+{
+    // Skip program name.
+    ArrayArguments args{argv + 1, std::max(argc - 1, 0)};
+
+    operands.clear();
+    return pimpl->process(*context.pimpl, args, Operands{operands});
+}
+
+ArgParse::Context::Context() : Context{std::pmr::get_default_resource()}
+{
+}
+
+ArgParse::Context::Context(std::pmr::memory_resource *resource) : pimpl{new (resource) Impl{resource}}
+{
+}
+
+ArgParse::Context::~Context() = default;
+
+void ArgParse::Context::instrument(Stats *stats)
+{
+    pimpl->stats = stats;
+}
+
+void ArgParse::instrument(Stats *stats)
+{
+    pimpl->context().instrument(stats);
+}
+
+void ArgParse::Stats::dump(std::ostream &os) const
+{
+    os << "parses: " << parses << '\n'
+       << "options: " << options << '\n'
+       << "operands: " << operands << '\n'
+       << "long lookups: " << longLookups << '\n'
+       << "short lookups: " << shortLookups << '\n'
+       << "dispatched: " << dispatched << '\n'
+       << "bytes allocated: " << bytesAllocated << '\n'
+       << "tokenize: " << tokenizeNanoseconds << " ns\n"
+       << "lookup: " << lookupNanoseconds << " ns\n"
+       << "required: " << requiredNanoseconds << " ns\n"
+       << "convert: " << convertNanoseconds << " ns\n"
+       << "dispatch: " << dispatchNanoseconds << " ns\n";
 }
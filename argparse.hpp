@@ -1,22 +1,234 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <initializer_list>
+#include <iosfwd>
 #include <memory>
+#include <memory_resource>
+#include <new>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 /// Command line argument parser.
 /// @discussion Provides methods to describe the set of supported options, render help, and process command line
 /// arguments.
+/// Once its options have been added, a const ArgParse is immutable and may be shared between threads: each thread
+/// parses with its own Context, which holds all per-parse state.
 /// @see https://pubs.opengroup.org/onlinepubs/9699919799/basedefs/V1_chap12.html
 class ArgParse
 {
+public:
+    template <typename Signature>
+    class Callback;
+
+    /// Callable wrapper which holds its target inline, and so never allocates.
+    /// @discussion Like std::function, except that the target must fit in @c capacity bytes, which is checked at
+    /// compile time. A larger callable which outlives the wrapper may be held by reference by passing
+    /// std::ref(callable), or wrapped in a std::function. Moving never throws, so containers of Callback move rather
+    /// than copy their elements as they grow; the target must therefore be nothrow move constructible.
+    template <typename R, typename... Args>
+    class Callback<R(Args...)>
+    {
+    public:
+        /// Size of the inline storage: enough for a lambda capturing six pointers or references.
+        static constexpr size_t capacity = 6 * sizeof(void *);
+
+    private:
+        enum class Operation
+        {
+            Copy,
+            Move,
+            Destroy
+        };
+
+        alignas(std::max_align_t) mutable unsigned char storage_[capacity];
+        R (*invoke_)(void *target, Args... args);
+        void (*manage_)(Operation operation, void *target, void *source);
+
+        template <typename F>
+        static R invoke(void *target, Args... args)
+        {
+            return (*static_cast<F *>(target))(std::forward<Args>(args)...);
+        }
+
+        template <typename F>
+        static void manage(Operation operation, void *target, void *source)
+        {
+            switch (operation) {
+                case Operation::Copy:
+                    new (target) F{*static_cast<const F *>(source)};
+                    break;
+                case Operation::Move:
+                    new (target) F{std::move(*static_cast<F *>(source))};
+                    break;
+                case Operation::Destroy:
+                    static_cast<F *>(target)->~F();
+                    break;
+            }
+        }
+
+        void assign(const Callback &other, Operation operation)
+        {
+            if (other.invoke_) {
+                other.manage_(operation, storage_, other.storage_);
+                invoke_ = other.invoke_;
+                manage_ = other.manage_;
+            }
+        }
+
+        void reset()
+        {
+            if (invoke_) {
+                manage_(Operation::Destroy, storage_, nullptr);
+                invoke_ = nullptr;
+                manage_ = nullptr;
+            }
+        }
+
+    public:
+        Callback() : storage_{}, invoke_{}, manage_{}
+        {
+        }
+
+        /// Hold a copy of @c f.
+        template <typename F,
+                  typename Target = std::decay_t<F>,
+                  typename = std::enable_if_t<!std::is_same_v<Target, Callback> &&
+                                              std::is_invocable_r_v<R, Target &, Args...>>>
+        Callback(F &&f) : storage_{}, invoke_{&invoke<Target>}, manage_{&manage<Target>}
+        {
+            static_assert(sizeof(Target) <= capacity, "callable is too large to hold inline; pass std::ref(callable)");
+            static_assert(alignof(Target) <= alignof(std::max_align_t), "callable is over-aligned");
+            static_assert(std::is_nothrow_move_constructible_v<Target>, "callable must be nothrow move constructible");
+            new (storage_) Target{std::forward<F>(f)};
+        }
+
+        ~Callback()
+        {
+            reset();
+        }
+
+        Callback(const Callback &other) : storage_{}, invoke_{}, manage_{}
+        {
+            assign(other, Operation::Copy);
+        }
+
+        Callback(Callback &&other) noexcept : storage_{}, invoke_{}, manage_{}
+        {
+            assign(other, Operation::Move);
+        }
+
+        auto operator=(const Callback &other) -> Callback &
+        {
+            if (this != &other) {
+                reset();
+                assign(other, Operation::Copy);
+            }
+            return *this;
+        }
+
+        auto operator=(Callback &&other) noexcept -> Callback &
+        {
+            if (this != &other) {
+                reset();
+                assign(other, Operation::Move);
+            }
+            return *this;
+        }
+
+        /// @return bool True if a target is held.
+        explicit operator bool() const
+        {
+            return invoke_ != nullptr;
+        }
+
+        /// Call the target.
+        auto operator()(Args... args) const -> R
+        {
+            return invoke_(storage_, std::forward<Args>(args)...);
+        }
+    };
+
+private:
     class Impl;
     std::unique_ptr<Impl> pimpl;
 
+    /// Describes the variable an option-argument is converted and stored in.
+    struct Binding {
+        enum class Type
+        {
+            None,
+            Int,
+            Int64,
+            Double,
+            Bool,
+            StringView,
+            Strings,
+            StringViews,
+            Enum
+        };
+
+        Type type;
+
+        /// Variable of type @c type.
+        void *target;
+
+        /// Enumerator names and values, if Type::Enum, allocated from the resource of the ArgParse. The names are
+        /// copied or viewed as copyStrings directs.
+        std::pmr::vector<std::pair<std::string_view, int64_t>> enumerators;
+
+        /// Assigns an enumerator value to @c target, if Type::Enum.
+        void (*assign)(void *target, int64_t value);
+    };
+
+    /// @return Binding::Type Conversion of option-arguments bound to a variable of type @c T.
+    template <typename T>
+    static constexpr auto bindingType() -> Binding::Type
+    {
+        if constexpr (std::is_same_v<T, int>) {
+            return Binding::Type::Int;
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+            return Binding::Type::Int64;
+        } else if constexpr (std::is_same_v<T, double>) {
+            return Binding::Type::Double;
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return Binding::Type::Bool;
+        } else if constexpr (std::is_same_v<T, std::string_view>) {
+            return Binding::Type::StringView;
+        } else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
+            return Binding::Type::Strings;
+        } else if constexpr (std::is_same_v<T, std::vector<std::string_view>>) {
+            return Binding::Type::StringViews;
+        } else {
+            return Binding::Type::None;
+        }
+    }
+
+    /// Add an option whose option-argument is stored through @c binding.
+    auto bind(char shortName,
+              const char *longName,
+              const char *parameter,
+              const char *description,
+              Binding binding,
+              const char *defaultValue,
+              bool required) -> size_t;
+
+    /// @return memory_resource Resource from which storage is allocated.
+    auto resource() const -> std::pmr::memory_resource *;
+
 public:
     ArgParse();
 
+    /// Construct an ArgParse whose storage is allocated from @c resource.
+    /// @discussion Options, help, and the state of parses made without a caller-owned context are allocated from
+    /// @c resource, which must outlive this object.
+    explicit ArgParse(std::pmr::memory_resource *resource);
+
     ~ArgParse();
     ArgParse(const ArgParse&) = delete;
     auto operator=(const ArgParse&) -> ArgParse & = delete;
@@ -29,11 +241,12 @@ public:
     /// @param description  Usage description.
     /// @param callback     Function called to process this option.
     /// @param defaultValue Default value (or empty string if none).
-    void add(char shortName,
+    /// @return size_t Option identifier.
+    auto add(char shortName,
              const char *longName,
              const char *description,
-             std::function<void()> callback,
-             const char *defaultValue = "");
+             Callback<void()> callback,
+             const char *defaultValue = "") -> size_t;
 
     /// Add an option which has an option-argument.
     /// @param shortName    Option character (or NUL if not used).
@@ -42,12 +255,13 @@ public:
     /// @param description  Usage description.
     /// @param callback     Function called to process this option.
     /// @param defaultValue Default value (or empty string if none).
-    void add(char shortName,
+    /// @return size_t Option identifier.
+    auto add(char shortName,
              const char *longName,
              const char *parameter,
              const char *description,
-             std::function<void(const std::string &)> callback,
-             const char *defaultValue = "");
+             Callback<void(const std::string &)> callback,
+             const char *defaultValue = "") -> size_t;
 
     /// Add an option which has an option-argument and is required.
     /// @param shortName    Option character (or NUL if not used).
@@ -56,16 +270,188 @@ public:
     /// @param description  Usage description.
     /// @param callback     Function called to process this option.
     /// @param required     True if option is required.
-    void add(char shortName,
+    /// @return size_t Option identifier.
+    auto add(char shortName,
+             const char *longName,
+             const char *parameter,
+             const char *description,
+             Callback<void(const std::string &)> callback,
+             bool required) -> size_t;
+
+    /// Add an option whose option-argument is converted and stored in @c target.
+    /// @discussion @c T is one of int, int64_t, double, bool or std::string_view. Numbers are converted with
+    /// std::from_chars, and bool accepts "true", "false", "yes", "no", "on", "off", "1" and "0".
+    /// Option-arguments are converted before any callback is called, and an option-argument which cannot be converted
+    /// is reported as Error::Kind::InvalidValue or Error::Kind::OutOfRange.
+    /// A std::string_view target views the argument list, so is only valid while the arguments are. The overloads of
+    /// process taking a std::vector<std::string> keep the arguments they remove in the context until its next parse.
+    /// A std::vector<std::string> or std::vector<std::string_view> target collects the option-argument of every
+    /// occurrence of the option, appended in argument order. Occurrences are counted while parsing so that the vector
+    /// is reserved once, and views are collected without further allocation.
+    /// @param shortName    Option character (or NUL if not used).
+    /// @param longName     Option name (or empty string if not used).
+    /// @param parameter    Parameter name.
+    /// @param description  Usage description.
+    /// @param target       Variable which is assigned the converted option-argument.
+    /// @param defaultValue Default value (or empty string if none).
+    /// @return size_t Option identifier.
+    template <typename T, typename = std::enable_if_t<bindingType<T>() != Binding::Type::None>>
+    auto add(char shortName,
+             const char *longName,
+             const char *parameter,
+             const char *description,
+             T &target,
+             const char *defaultValue = "") -> size_t
+    {
+        return bind(shortName, longName, parameter, description, {bindingType<T>(), &target, {}, {}}, defaultValue,
+                    false);
+    }
+
+    /// Add an option whose option-argument is converted and stored in @c target, and which is required.
+    /// @see add
+    template <typename T, typename = std::enable_if_t<bindingType<T>() != Binding::Type::None>>
+    auto add(char shortName, const char *longName, const char *parameter, const char *description, T &target,
+             bool required) -> size_t
+    {
+        return bind(shortName, longName, parameter, description, {bindingType<T>(), &target, {}, {}}, "", required);
+    }
+
+    /// Add an option whose option-argument names an enumerator which is stored in @c target.
+    /// @discussion Option-arguments must match an enumerator name exactly, otherwise Error::Kind::InvalidValue is
+    /// reported.
+    /// @param enumerators  Enumerator names and values.
+    /// @see add
+    template <typename Enum, typename = std::enable_if_t<std::is_enum_v<Enum>>>
+    auto add(char shortName,
              const char *longName,
              const char *parameter,
              const char *description,
-             std::function<void(const std::string &)> callback,
-             bool required);
+             Enum &target,
+             std::initializer_list<std::pair<const char *, Enum>> enumerators,
+             const char *defaultValue = "") -> size_t
+    {
+        using Enumerators = decltype(Binding::enumerators);
+        Binding binding{Binding::Type::Enum, &target, Enumerators{resource()},
+                        [](void *t, int64_t value) { *static_cast<Enum *>(t) = static_cast<Enum>(value); }};
+        binding.enumerators.reserve(enumerators.size());
+        for (const auto &[name, value] : enumerators) {
+            binding.enumerators.emplace_back(name, static_cast<int64_t>(value));
+        }
+        return bind(shortName, longName, parameter, description, std::move(binding), defaultValue, false);
+    }
+
+    /// Constraint on a group of options.
+    enum class Constraint
+    {
+        /// Exactly one of the options must be given.
+        ExactlyOne,
+        /// At most one of the options may be given.
+        AtMostOne,
+        /// If the first option is given then each of the others must be given.
+        Requires
+    };
+
+    /// Constrain which of a group of options may be given together.
+    /// @discussion Constraints are checked along with required options once the arguments have been parsed, as
+    /// operations on bitmasks of the options which were given, and are checked in the order they were added. They are
+    /// reported as Error::Kind::ConflictingOptions, Error::Kind::MissingOneOf or Error::Kind::MissingDependency.
+    /// @param constraint   Constraint.
+    /// @param options      Option identifiers, as returned by add.
+    void constrain(Constraint constraint, std::initializer_list<size_t> options);
+
+    /// Add a command.
+    /// @discussion Once a command has been added, the first operand before any "--" selects a command, and the
+    /// arguments which follow it are parsed with the options of that command. Each command has its own ArgParse, which
+    /// is created and passed to @c factory only when the command is selected, so that commands which are not selected
+    /// cost nothing.
+    /// A command's ArgParse, whose help describes its options, remains valid until the Context which selected it is
+    /// next used to parse, or is destroyed. Options of the command are dispatched after those which precede it, and
+    /// errors in its arguments name it in Error::command.
+    /// The incremental Parser does not select commands.
+    /// @param name        Command name.
+    /// @param description Usage description.
+    /// @param factory     Function called to add the options of the command when it is selected.
+    void addCommand(const char *name, const char *description, Callback<void(ArgParse &)> factory);
+
+    /// Runs a task on any thread.
+    using Executor = Callback<void(Callback<void()>)>;
+
+    /// Mark option @c id as independent of every other option.
+    /// @discussion The callbacks of independent options are called concurrently, with each other and with those of
+    /// other options, which are still called in argument order on the thread calling process. The occurrences of any
+    /// one option are dispatched in argument order by a single task, so the last still wins. If a callback of an
+    /// independent option throws, process reports the first such occurrence in argument order as
+    /// Error::Kind::CallbackFailed, once every callback has returned. Options bound to a vector are always dispatched
+    /// in argument order, so are not marked.
+    /// @param id Option identifier, as returned by add.
+    void independent(size_t id);
+
+    /// Run the callbacks of independent options as tasks of @c executor.
+    /// @discussion By default a few threads are started by each parse which has independent options to dispatch.
+    /// @c executor may instead pass tasks to an existing thread pool, and process waits until they have finished. If
+    /// @c executor throws then the options remaining are dispatched on the thread calling process. Starting a thread
+    /// allocates from the global heap, which a parse using an executor avoids.
+    void executor(Executor executor);
+
+    /// Copy the strings given to add and addCommand (the default), or store views of them.
+    /// @discussion Viewing strings saves memory and allocation when they have static lifetime, as string literals do.
+    /// Viewed strings must remain valid and unchanged for the lifetime of this object. Applies to options and commands
+    /// added after the call, so copying can be enabled just for strings which are built dynamically.
+    void copyStrings(bool copy);
+
+    /// Expand response files.
+    /// @discussion When enabled, each argument of the form "@file" is replaced by the arguments read from @c file.
+    /// Arguments in a response file are separated by white space. Single and double quotes group characters, including
+    /// white space, into one argument, and backslash escapes the following character. Response files may name further
+    /// response files.
+    /// Response files are mapped into memory and tokenized in place as they are parsed, so option-arguments and operands
+    /// read from them are views into the mapping. The mappings remain valid until the same Context is next used to
+    /// parse, or is destroyed.
+    /// @param maxDepth Maximum nesting of response files, or zero to disable expansion (the default).
+    void expandResponseFiles(size_t maxDepth = 8);
 
     /// Render description to stdout.
+    /// @discussion The description is rendered into a single buffer, which is cached until an option is added.
     void help() const;
 
+    /// Render description to @c os.
+    void help(std::ostream &os) const;
+
+    /// Render description to file descriptor @c fd.
+    /// @return bool True if the description was written in full.
+    auto help(int fd) const -> bool;
+
+    /// @return std::string Rendered description.
+    auto helpText() const -> std::string;
+
+    /// Shell for which a completion script is generated.
+    enum class Shell
+    {
+        Bash,
+        Zsh,
+        Fish
+    };
+
+    /// Write the completions of argument @c index of @c argv to @c os.
+    /// @discussion Each completion is written as a line holding the candidate and, after a tab, the first line of its
+    /// description. An option which expects an option-argument is written as a line holding a tab and its parameter
+    /// name, and an operand, unless it names a command, has no completions. Long options are matched by the same
+    /// prefix search as parsing, so completion costs little even for thousands of options. The arguments preceding
+    /// @c index are read only to find an option expecting an option-argument, the "--" delimiter, and the command
+    /// whose options complete the remaining arguments. Nothing is written if @c index is negative or exceeds @c argc.
+    /// @param argc  Argument count, as passed to main.
+    /// @param argv  Argument vector, as passed to main.
+    /// @param index Position in @c argv of the argument to complete, which may be @c argc for a new argument.
+    /// @see completionScript
+    void complete(std::ostream &os, int argc, char *const *argv, int index) const;
+
+    /// Write a script which has @c shell complete the arguments of @c program.
+    /// @discussion On each completion the script runs @c program with the arguments typed so far, and the environment
+    /// variable ARGPARSE_COMPLETE holding the index of the argument to complete. The program should then call
+    /// complete, and exit.
+    /// @param program Command name of the program.
+    static void completionScript(std::ostream &os, Shell shell, std::string_view program);
+
     struct Error {
         enum class Kind
         {
@@ -82,31 +468,220 @@ public:
             /// An unexpected option-argument of the form --long=ARG was given.
             UnexpectedArgument,
             /// A required option was not given.
-            MissingOption
+            MissingOption,
+            /// A response file of the form '@file' could not be read.
+            UnreadableResponseFile,
+            /// Response files were nested more deeply than allowed.
+            ResponseFileNesting,
+            /// An option-argument could not be converted to the type of its variable.
+            InvalidValue,
+            /// An option-argument was outside the range of the type of its variable.
+            OutOfRange,
+            /// An unrecognized command was given.
+            UnrecognizedCommand,
+            /// Two options which cannot be used together were given.
+            ConflictingOptions,
+            /// None of a group of options, one of which is required, was given.
+            MissingOneOf,
+            /// An option was given without an option it requires.
+            MissingDependency,
+            /// The callback of an independent option threw an exception.
+            CallbackFailed
         };
 
         /// Error kind.
         Kind kind;
 
-        /// Descriptive message.
-        std::string message;
+        /// Name of the offending option (or empty string if none).
+        std::string name;
+
+        /// Offending option-argument, or explanation of Error::Kind::CallbackFailed (or empty string if none).
+        std::string value;
+
+        /// Second option named by a constraint (or empty string if none). For Error::Kind::MissingOneOf, @c name
+        /// lists the options of the group, separated by '|'.
+        std::string other;
+
+        /// Command whose arguments are in error (or empty string if none), with nested commands separated by spaces.
+        std::string command;
+
+        /// Name of a supported option which an Error::Kind::UnrecognizedOption may be a misspelling of (or empty string
+        /// if none).
+        std::string suggestion;
 
         Error();
-        Error(Kind kind, const std::string &option);
+        Error(Kind kind, std::string_view name, std::string_view value = {});
 
         /// @return true If object describes a non-None error.
         operator bool() const;
+
+        /// @return std::string Descriptive message, or the empty string if Error::Kind::None.
+        auto message() const -> std::string;
+
+        /// Write descriptive message to @c os.
+        void format(std::ostream &os) const;
     };
 
+    /// Statistics of parses.
+    /// @discussion Accumulated by each parse made with an instrumented Context. Timings are in nanoseconds, and
+    /// tokenization excludes lookups and required option checks. Instrumentation costs a branch per phase when not
+    /// enabled, and nothing if the library is built with ARGPARSE_STATS defined as 0.
+    /// @see Context::instrument
+    struct Stats {
+        /// Number of parses.
+        size_t parses{};
+
+        /// Number of options and operands found.
+        size_t options{};
+        size_t operands{};
+
+        /// Number of lookups of long names and of option characters.
+        size_t longLookups{};
+        size_t shortLookups{};
+
+        /// Number of options dispatched to callbacks or variables.
+        size_t dispatched{};
+
+        /// Bytes allocated to grow parse state and operands, and to copy option-arguments for callbacks.
+        size_t bytesAllocated{};
+
+        /// Time reading and classifying arguments.
+        uint64_t tokenizeNanoseconds{};
+
+        /// Time looking up long names and option characters.
+        uint64_t lookupNanoseconds{};
+
+        /// Time checking that required options were given.
+        uint64_t requiredNanoseconds{};
+
+        /// Time converting option-arguments of variables.
+        uint64_t convertNanoseconds{};
+
+        /// Time calling callbacks and assigning variables.
+        uint64_t dispatchNanoseconds{};
+
+        /// Write statistics to @c os, one per line.
+        void dump(std::ostream &os) const;
+    };
+
+    /// State of a parse.
+    /// @discussion Holds the position of the parse, which options were given and the options pending callback, so that
+    /// concurrent parses by one ArgParse do not share state. Storage is retained, so reusing a context avoids
+    /// allocation.
+    class Context
+    {
+        friend class ArgParse;
+        class Impl;
+        std::unique_ptr<Impl> pimpl;
+
+    public:
+        Context();
+
+        /// Construct a context whose storage is allocated from @c resource, which must outlive this object.
+        explicit Context(std::pmr::memory_resource *resource);
+
+        ~Context();
+        Context(const Context&) = delete;
+        auto operator=(const Context&) -> Context & = delete;
+        Context(Context&&) = delete;
+        auto operator=(Context&&) -> Context & = delete;
+
+        /// Accumulate statistics of parses made with this context into @c stats, or stop if @c stats is null.
+        void instrument(Stats *stats);
+    };
+
+    /// Accumulate statistics of parses made without a caller-owned context into @c stats, or stop if @c stats is null.
+    /// @see Stats
+    void instrument(Stats *stats);
+
     /// Parse argument list.
     /// @discussion Parses a command line argument list @c argv to identify options.
     /// Options begin with either short delimiter "-" or long delimiter "--".
     /// Options and other arguments may be intermixed.
     /// Long options partially match if there is no ambiguity.
+    /// If several options share an option character then the first one added is used.
     /// Use special delimiter "--" to terminate argument processing.
     /// An error is returned if any invalid or unrecognized options are found, or if any arguments are missing, or if
     /// any required options are missing. Otherwise the callback functions are called and success is returned.
     /// @see add
+    /// Options and option-arguments are removed from @c argv, leaving the operands.
     /// @return Error Descriptive message or Error::Kind::None if parsing successful.
     auto process(std::vector<std::string> &argv) -> Error;
+
+    /// Parse argument list without copying it.
+    /// @discussion As above, except that arguments are read directly from @c argv as passed to @c main, and
+    /// @c argv[0] (the program name) is skipped.
+    /// Options are consumed and @c operands is cleared and then filled with views into @c argv of the remaining
+    /// arguments. Reuse @c operands across calls to avoid allocation.
+    /// @see process
+    auto process(int argc, char *const *argv, std::vector<std::string_view> &operands) -> Error;
+
+    /// Parse argument list using caller-owned state.
+    /// @discussion As above, except that all per-parse state is held in @c context, so that any number of threads may
+    /// parse concurrently with one ArgParse, each using its own context. Callbacks are called on the parsing thread.
+    /// @see process
+    auto process(Context &context, std::vector<std::string> &argv) const -> Error;
+
+    /// Parse argument list without copying it, using caller-owned state.
+    /// @see process
+    auto process(Context &context, int argc, char *const *argv, std::vector<std::string_view> &operands) const
+        -> Error;
+
+    /// An event of an incremental parse.
+    /// @see Parser
+    struct Event {
+        enum class Kind
+        {
+            /// An option was given.
+            Option,
+            /// An operand was given.
+            Operand,
+            /// The argument list was parsed successfully.
+            End,
+            /// The argument list is invalid.
+            Error
+        };
+
+        /// Event kind.
+        Kind kind;
+
+        /// Identifier of the option, as returned by add, if Kind::Option.
+        size_t id;
+
+        /// Option-argument (or empty string if none) if Kind::Option, or the operand if Kind::Operand.
+        std::string_view arg;
+
+        /// Error, if Kind::Error.
+        ArgParse::Error error;
+    };
+
+    /// Incremental parser.
+    /// @discussion Parses an argument list one event at a time, so that options and operands may be acted on as they
+    /// are found, without buffering. Events view @c argv, and parsing does not allocate once @c context has been used,
+    /// except to read response files.
+    /// Callbacks are not called and variables are not assigned; pass Option events to dispatch to do so.
+    /// All state is held in @c context, which must not be used for another parse until this one is finished.
+    /// @see process
+    class Parser
+    {
+        const ArgParse &argParse_;
+        Context &context_;
+
+    public:
+        /// Begin parsing @c argv as passed to @c main; @c argv[0] (the program name) is skipped.
+        Parser(const ArgParse &argParse, Context &context, int argc, char *const *argv);
+
+        /// Parse the next event.
+        /// @discussion Once Event::Kind::End or Event::Kind::Error has been returned, every call returns
+        /// Event::Kind::End. Required options are checked at the end of the argument list.
+        /// @return Event Next option, operand, or error, or Event::Kind::End if the argument list is finished.
+        auto next() -> Event;
+    };
+
+    /// Act on an option event.
+    /// @discussion Calls the callback of the option, or converts the option-argument and assigns it to the variable of
+    /// the option. Other events are ignored.
+    /// @return Error Error::Kind::InvalidValue or Error::Kind::OutOfRange if the option-argument could not be
+    /// converted, otherwise Error::Kind::None.
+    auto dispatch(const Event &event) const -> Error;
 };
@@ -0,0 +1,322 @@
+#include "argparse.hpp"
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/// Minimum measurement time per benchmark.
+const auto minimumDuration = std::chrono::milliseconds{200};
+
+/// Option characters available for short options.
+const std::string shortNames{"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+
+/// getopt_long scans every long option for each argument and permutes operands one at a time, so it is not run for
+/// more arguments than this, or where the table size times the argument count exceeds @c getoptWorkLimit.
+const size_t getoptArgumentLimit{100000};
+const size_t getoptWorkLimit{100000000};
+
+/// Prevents the compiler from discarding work.
+size_t sink{};
+
+/// Stream buffer which discards its output.
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override
+    {
+        return c;
+    }
+
+    std::streamsize xsputn(const char *, std::streamsize n) override
+    {
+        return n;
+    }
+};
+
+/// @return std::string Long name of option @c i.
+std::string longName(size_t i)
+{
+    return "name-" + std::to_string(i) + "-flag";
+}
+
+/// @return std::string Long name of option-argument taking option @c i.
+std::string valueName(size_t i)
+{
+    return "name-" + std::to_string(i) + "-value";
+}
+
+/// An argument list, held both as strings and as the argv array passed to main.
+struct Arguments {
+    std::vector<std::string> strings;
+    std::vector<char *> argv;
+
+    explicit Arguments(std::vector<std::string> args) : strings{std::move(args)}, argv{}
+    {
+        strings.insert(strings.begin(), "program");
+        for (auto &str : strings) {
+            argv.push_back(str.data());
+        }
+        argv.push_back(nullptr);
+    }
+
+    int argc() const
+    {
+        return static_cast<int>(strings.size());
+    }
+};
+
+/// Run @c f repeatedly for at least @c minimumDuration.
+/// @return double Mean nanoseconds per call.
+double measure(const std::function<void()> &f)
+{
+    using clock = std::chrono::steady_clock;
+
+    size_t iterations{};
+    auto start = clock::now();
+    auto elapsed = clock::duration{};
+    do {
+        f();
+        iterations++;
+        elapsed = clock::now() - start;
+    } while (elapsed < minimumDuration);
+
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+           static_cast<double>(iterations);
+}
+
+/// Write one result as CSV.
+void report(const char *benchmark, const char *parser, size_t options, size_t arguments, double ns)
+{
+    std::cout << benchmark << ',' << parser << ',' << options << ',' << arguments << ',' << static_cast<size_t>(ns)
+              << ',' << (arguments ? ns / static_cast<double>(arguments) : 0) << std::endl;
+}
+
+/// An option table of @c count flags and @c count option-argument taking options, registered with both parsers.
+struct Table {
+    ArgParse ap;
+    std::vector<std::string> names;
+    std::vector<struct option> longopts;
+    std::string optstring;
+
+    explicit Table(size_t count) : ap{}, names{}, longopts{}, optstring{}
+    {
+        for (size_t i = 0; i < count; ++i) {
+            names.push_back(longName(i));
+            names.push_back(valueName(i));
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            char c = i < shortNames.size() ? shortNames[i] : '\0';
+            ap.add(c, names[2 * i].c_str(), "Describe flag.", []() { sink++; });
+            ap.add({}, names[2 * i + 1].c_str(), "VALUE", "Describe value.\nOn two lines.",
+                   [](const std::string &arg) { sink += arg.size(); });
+
+            longopts.push_back({names[2 * i].c_str(), no_argument, nullptr, c ? c : 256});
+            longopts.push_back({names[2 * i + 1].c_str(), required_argument, nullptr, 257});
+            if (c) {
+                optstring += c;
+            }
+        }
+        longopts.push_back({nullptr, 0, nullptr, 0});
+    }
+};
+
+/// Parse @c args with ArgParse, without copying.
+double runArgParse(Table &table, const Arguments &args)
+{
+    std::vector<std::string_view> operands;
+    return measure([&]() {
+        auto err = table.ap.process(args.argc(), args.argv.data(), operands);
+        if (err) {
+            std::cerr << "bench: " << err.message() << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        sink += operands.size();
+    });
+}
+
+/// Parse @c args with getopt_long.
+/// @discussion getopt_long permutes its argument list, so each iteration parses a copy of the pointer array.
+double runGetopt(Table &table, const Arguments &args)
+{
+    std::vector<char *> argv;
+    return measure([&]() {
+        argv = args.argv;
+        optind = 0;
+        opterr = 0;
+        auto argc = args.argc();
+        auto optstring = table.optstring.c_str();
+        auto longopts = table.longopts.data();
+        for (int c; (c = getopt_long(argc, argv.data(), optstring, longopts, nullptr)) != -1;) {
+            if (c == '?' || c == ':') {
+                std::cerr << "bench: getopt_long failed" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            sink += optarg ? std::strlen(optarg) : 1;
+        }
+        sink += static_cast<size_t>(args.argc() - optind);
+    });
+}
+
+/// Build an argument list of @c count arguments from @c make.
+std::vector<std::string> generate(size_t count, const std::function<std::string(size_t)> &make)
+{
+    std::vector<std::string> args;
+    args.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        args.push_back(make(i));
+    }
+    return args;
+}
+
+void benchProcess(const char *benchmark,
+                  size_t options,
+                  size_t arguments,
+                  const std::function<std::string(size_t)> &make)
+{
+    Table table{options};
+    Arguments args{generate(arguments, make)};
+    report(benchmark, "argparse", options, arguments, runArgParse(table, args));
+    if (arguments <= getoptArgumentLimit && options * arguments <= getoptWorkLimit) {
+        report(benchmark, "getopt_long", options, arguments, runGetopt(table, args));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    std::cout << "benchmark,parser,options,arguments,ns_per_parse,ns_per_argument" << std::endl;
+
+    const size_t tableSizes[] = {10, 100, 1000, 5000};
+    const size_t argumentCounts[] = {10, 1000, 100000, 1000000};
+
+    for (auto options : tableSizes) {
+        for (auto arguments : argumentCounts) {
+            // Long options given in full, interleaved with operands.
+            benchProcess("long", options, arguments, [options](size_t i) {
+                return i % 2 ? "file-" + std::to_string(i) : "--" + longName(i * 7919 % options);
+            });
+        }
+    }
+
+    for (auto options : tableSizes) {
+        const size_t arguments = 100000;
+
+        // Clusters of short options.
+        benchProcess("short-grouped", options, arguments, [options](size_t i) {
+            std::string str{"-"};
+            for (size_t j = 0; j < 8; ++j) {
+                str += shortNames[(i + j) % std::min(options, shortNames.size())];
+            }
+            return str;
+        });
+
+        // Long options abbreviated by dropping their last three characters, which leaves each prefix unambiguous.
+        benchProcess("long-abbreviated", options, arguments, [options](size_t i) {
+            auto name = longName(i * 7919 % options);
+            return "--" + name.substr(0, name.size() - 3);
+        });
+
+        // Long options with an option-argument.
+        benchProcess("long-value", options, arguments, [options](size_t i) {
+            return "--" + valueName(i * 7919 % options) + "=" + std::to_string(i);
+        });
+    }
+
+    for (size_t options : {10000, 100000}) {
+        const size_t arguments = 100000;
+
+        // Long options given in full, looked up in tables too large for getopt_long.
+        benchProcess("lookup", options, arguments, [options](size_t i) { return "--" + longName(i * 7919 % options); });
+    }
+
+    for (auto options : tableSizes) {
+        Table table{options};
+
+        // Write help, discarding the output. Help is rendered once, so this measures writing the cached text.
+        NullBuffer null;
+        auto buf = std::cout.rdbuf(&null);
+        auto cached = measure([&]() { table.ap.help(); });
+
+        // Register the same options in a fresh parser and render its help, so that every iteration renders.
+        auto cold = measure([&]() {
+            ArgParse ap;
+            ap.copyStrings(false);
+            for (size_t i = 0; i < options; ++i) {
+                char c = i < shortNames.size() ? shortNames[i] : '\0';
+                ap.add(c, table.names[2 * i].c_str(), "Describe flag.", []() { sink++; });
+                ap.add({}, table.names[2 * i + 1].c_str(), "VALUE", "Describe value.\nOn two lines.",
+                       [](const std::string &arg) { sink += arg.size(); });
+            }
+            ap.help();
+        });
+        std::cout.rdbuf(buf);
+        report("help", "argparse", options, 0, cached);
+        report("help-cold", "argparse", options, 0, cold);
+    }
+
+    for (size_t options : {1000, 10000}) {
+        std::vector<std::string> names;
+        ArgParse ap;
+        for (size_t i = 0; i < options; ++i) {
+            names.push_back(longName(i));
+            ap.add({}, names.back().c_str(), "Describe flag.", []() { sink++; });
+        }
+
+        // Report a misspelled long option, suggesting the nearest name.
+        auto misspelled = longName(options / 2);
+        std::swap(misspelled[misspelled.size() - 1], misspelled[misspelled.size() - 2]);
+        Arguments args{{"--" + misspelled}};
+        std::vector<std::string_view> operands;
+        auto ns = measure([&]() {
+            auto err = ap.process(args.argc(), args.argv.data(), operands);
+            if (err.suggestion != longName(options / 2)) {
+                std::cerr << "bench: " << err.message() << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            sink += operands.size();
+        });
+        report("suggest", "argparse", options, 1, ns);
+
+        // Complete a long option prefix, discarding the output.
+        NullBuffer null;
+        std::ostream os{&null};
+        Arguments prefix{{"--" + longName(options / 2).substr(0, 8)}};
+        ns = measure([&]() { ap.complete(os, prefix.argc(), prefix.argv.data(), 1); });
+        report("complete", "argparse", options, 1, ns);
+    }
+
+    for (size_t options : {10, 100, 1000, 5000, 100000}) {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < options; ++i) {
+            names.push_back(longName(i));
+        }
+
+        // Register options, copying or viewing their strings, and then parse one, which sorts the long names.
+        for (auto copy : {true, false}) {
+            auto ns = measure([&]() {
+                ArgParse ap;
+                ap.copyStrings(copy);
+                for (const auto &name : names) {
+                    ap.add({}, name.c_str(), "Describe flag.\nOn two lines, at greater length than a short string.",
+                           []() { sink++; });
+                }
+                std::vector<std::string> argv{"--" + names.front()};
+                sink += !ap.process(argv);
+            });
+            report("register", copy ? "argparse" : "argparse-view", options, 0, ns);
+        }
+    }
+
+    return sink == 0;
+}
@@ -0,0 +1,437 @@
+#pragma once
+
+#include "argparse.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// Describes an option of a StaticArgParse, independent of its callback.
+struct StaticOptionInfo {
+    /// Option character (or NUL if not used).
+    char shortName;
+    /// Option name (or empty string if not used).
+    std::string_view longName;
+    /// Parameter name (or empty string if the option has no option-argument).
+    std::string_view parameter;
+    /// True if option is required.
+    bool required;
+
+    /// @return std::string_view Option name, preferring @c longName if available.
+    constexpr std::string_view name() const
+    {
+        if (longName.size()) {
+            return longName;
+        }
+        if (shortName) {
+            return {&shortName, 1};
+        }
+        return {};
+    }
+};
+
+namespace argparse_detail
+{
+
+/// @return size_t The smallest power of two which is at least @c n.
+constexpr size_t ceilPowerOfTwo(size_t n)
+{
+    size_t p{1};
+    while (p < n) {
+        p *= 2;
+    }
+    return p;
+}
+
+} // namespace argparse_detail
+
+/// Describes an option of a StaticArgParse.
+/// @discussion The callback is stored by value and called directly, so that it may be inlined.
+template <typename Callback>
+struct StaticOption : StaticOptionInfo {
+    Callback callback;
+
+    /// Describe an option.
+    /// @param shortName Option character (or NUL if not used).
+    /// @param longName  Option name (or empty string if not used).
+    /// @param callback  Function called to process this option, invocable as @c callback().
+    constexpr StaticOption(char shortName, std::string_view longName, Callback callback)
+        : StaticOptionInfo{shortName, longName, {}, false}, callback{std::move(callback)}
+    {
+        static_assert(std::is_invocable_v<const Callback &>, "callback must be invocable with no arguments");
+    }
+
+    /// Describe an option which has an option-argument.
+    /// @param shortName Option character (or NUL if not used).
+    /// @param longName  Option name (or empty string if not used).
+    /// @param parameter Parameter name.
+    /// @param callback  Function called to process this option, invocable as @c callback(std::string_view).
+    /// @param required  True if option is required.
+    constexpr StaticOption(
+        char shortName, std::string_view longName, std::string_view parameter, Callback callback, bool required = false)
+        : StaticOptionInfo{shortName, longName, parameter, required}, callback{std::move(callback)}
+    {
+        static_assert(std::is_invocable_v<const Callback &, std::string_view>,
+                      "callback must be invocable with a std::string_view option-argument");
+    }
+};
+
+/// Command line argument parser for an option set known at compile time.
+/// @discussion The option tables are computed when the parser is constructed, which may be at compile time:
+/// option characters map directly to options, exact long names are found through a perfect hash, and abbreviations
+/// are resolved by binary search of the long names in order. Callbacks are statically known, so dispatch compiles to
+/// direct calls.
+/// Parsing follows the same rules and reports the same errors as ArgParse::process, and does not allocate.
+/// @code
+/// const StaticArgParse parser{
+///     StaticOption{'v', "verbose", [&]() { verbosity++; }},
+///     StaticOption{'o', "output", "FILE", [&](std::string_view arg) { output = arg; }},
+/// };
+/// auto err = parser.process(argc, argv, operands);
+/// @endcode
+/// @see ArgParse::process
+template <typename... Callbacks>
+class StaticArgParse
+{
+    static constexpr size_t size_ = sizeof...(Callbacks);
+
+    /// Number of perfect hash slots, keeping the load factor at most one half.
+    static constexpr size_t slots_ = argparse_detail::ceilPowerOfTwo(2 * size_);
+
+    /// Number of displacement attempts per perfect hash bucket before falling back to binary search.
+    static constexpr uint32_t maxDisplacement_ = 1024;
+
+    std::tuple<StaticOption<Callbacks>...> options_;
+
+    /// The options, independent of their callbacks, so that they may be indexed at runtime.
+    std::array<StaticOptionInfo, size_> info_;
+
+    /// Index into @c options_ plus one for each option character, or zero if the character is not used.
+    std::array<size_t, 256> shortIndex_;
+
+    /// Indices into @c options_, ordered by long name.
+    std::array<size_t, size_> longIndex_;
+
+    /// Perfect hash displacement for each bucket.
+    std::array<uint32_t, size_> displacement_;
+
+    /// Index into @c options_ plus one for each perfect hash slot, or zero if the slot is unused.
+    std::array<size_t, slots_> hashIndex_;
+
+    /// True if the perfect hash was constructed.
+    bool hashed_;
+
+    /// FNV-1a hash of @c name, perturbed by @c seed.
+    static constexpr uint32_t hash(std::string_view name, uint32_t seed)
+    {
+        uint32_t h{2166136261u ^ (seed * 16777619u)};
+        for (auto c : name) {
+            h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+        }
+        return h;
+    }
+
+    /// Build the perfect hash of long names which resolve exactly, by hash and displace.
+    /// @discussion Only names which are not a prefix of any other name are hashed; the rest are ambiguous or empty and
+    /// are left to binary search. Names are distributed to buckets by an initial hash. Buckets are placed in
+    /// decreasing order of size, each using the first displacement which maps all its names to free slots.
+    /// @return bool False if some bucket could not be placed.
+    constexpr bool buildHash()
+    {
+        std::array<bool, size_> exact{};
+        for (size_t i = 0; i < size_; ++i) {
+            const auto &name = info_[i].longName;
+            exact[i] = !name.empty();
+            for (size_t j = 0; j < size_; ++j) {
+                if (j != i && info_[j].longName.substr(0, name.size()) == name) {
+                    exact[i] = false;
+                }
+            }
+        }
+
+        std::array<size_t, size_> bucket{};
+        std::array<size_t, size_> bucketSize{};
+        size_t largest{};
+        for (size_t i = 0; i < size_; ++i) {
+            if (exact[i]) {
+                bucket[i] = hash(info_[i].longName, 0) % size_;
+                largest = std::max(largest, ++bucketSize[bucket[i]]);
+            }
+        }
+
+        for (auto n = largest; n > 0; --n) {
+            for (size_t b = 0; b < size_; ++b) {
+                if (bucketSize[b] != n) {
+                    continue;
+                }
+
+                auto placed = false;
+                for (uint32_t d = 1; !placed && d <= maxDisplacement_; ++d) {
+                    placed = true;
+                    for (size_t i = 0; i < size_; ++i) {
+                        if (exact[i] && bucket[i] == b) {
+                            auto &slot = hashIndex_[hash(info_[i].longName, d) % slots_];
+                            if (slot) {
+                                placed = false;
+                                break;
+                            }
+                            slot = i + 1;
+                        }
+                    }
+
+                    if (placed) {
+                        displacement_[b] = d;
+                    } else {
+                        // Release the slots claimed by this bucket.
+                        for (auto &slot : hashIndex_) {
+                            if (slot && bucket[slot - 1] == b) {
+                                slot = 0;
+                            }
+                        }
+                    }
+                }
+
+                if (!placed) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /// Result of looking up an option.
+    struct Match {
+        ArgParse::Error::Kind kind;
+        size_t index;
+    };
+
+    /// @brief Lookup long name.
+    /// @discussion Find option having long name @c name.
+    /// Unambigious partial matches are supported.
+    constexpr Match lookupLongName(std::string_view name) const
+    {
+        if (hashed_ && size_) {
+            auto slot = hashIndex_[hash(name, displacement_[hash(name, 0) % size_]) % slots_];
+            if (slot && info_[slot - 1].longName == name) {
+                return {ArgParse::Error::Kind::None, slot - 1};
+            }
+        }
+
+        size_t lower{};
+        size_t upper{size_};
+        while (lower < upper) {
+            auto mid = lower + (upper - lower) / 2;
+            if (info_[longIndex_[mid]].longName.substr(0, name.size()) < name) {
+                lower = mid + 1;
+            } else {
+                upper = mid;
+            }
+        }
+
+        upper = size_;
+        for (auto first = lower; first < upper;) {
+            auto mid = first + (upper - first) / 2;
+            if (info_[longIndex_[mid]].longName.substr(0, name.size()) > name) {
+                upper = mid;
+            } else {
+                first = mid + 1;
+            }
+        }
+
+        if (upper - lower > 1) {
+            return {ArgParse::Error::Kind::AmbiguousOption, {}};
+        }
+
+        if (upper - lower == 1) {
+            return {ArgParse::Error::Kind::None, longIndex_[lower]};
+        }
+
+        return {ArgParse::Error::Kind::UnrecognizedOption, {}};
+    }
+
+    template <size_t I>
+    void call(std::string_view arg) const
+    {
+        const auto &callback = std::get<I>(options_).callback;
+        if constexpr (std::is_invocable_v<decltype(callback), std::string_view>) {
+            callback(arg);
+        } else {
+            callback();
+        }
+    }
+
+    template <size_t... I>
+    void dispatch(size_t index, std::string_view arg, std::index_sequence<I...>) const
+    {
+        ((index == I ? call<I>(arg) : void()), ...);
+    }
+
+    /// Parse argument list, calling @c visit with the index and option-argument of each option found.
+    /// @discussion Operands are appended to @c operands if not null.
+    template <typename Visit>
+    ArgParse::Error parse(int argc, char *const *argv, std::vector<std::string_view> *operands, Visit visit) const
+    {
+        constexpr std::string_view shortDelimiter{"-"};
+        constexpr std::string_view longDelimiter{"--"};
+
+        auto operand = [&](std::string_view str) {
+            if (operands) {
+                operands->push_back(str);
+            }
+        };
+
+        // Skip program name.
+        int i{1};
+        auto next = [&](std::string_view &str) {
+            if (i >= argc) {
+                return false;
+            }
+            str = argv[i++];
+            return true;
+        };
+
+        auto fail = [&](ArgParse::Error::Kind kind, std::string_view name) {
+            // Leave the arguments which were not processed.
+            for (std::string_view str; next(str);) {
+                operand(str);
+            }
+            return ArgParse::Error{kind, name};
+        };
+
+        for (std::string_view str; next(str);) {
+            if (str.substr(0, shortDelimiter.size()) != shortDelimiter) {
+                operand(str);
+                continue;
+            }
+
+            if (str == longDelimiter) {
+                while (next(str)) {
+                    operand(str);
+                }
+                break;
+            }
+
+            if (str.substr(0, longDelimiter.size()) == longDelimiter) {
+                str.remove_prefix(longDelimiter.size());
+
+                std::string_view arg{};
+                auto off = str.find('=');
+                auto hasParameter = off != std::string_view::npos;
+                if (hasParameter) {
+                    arg = str.substr(off + 1);
+                    str = str.substr(0, off);
+                }
+
+                auto [kind, index] = lookupLongName(str);
+                if (kind != ArgParse::Error::Kind::None) {
+                    return fail(kind, str);
+
+                } else if (info_[index].parameter.size()) {
+                    if (hasParameter || next(arg)) {
+                        visit(index, arg);
+                    } else {
+                        return fail(ArgParse::Error::Kind::RequiresArgument, info_[index].longName);
+                    }
+
+                } else if (hasParameter) {
+                    return fail(ArgParse::Error::Kind::UnexpectedArgument, info_[index].longName);
+
+                } else {
+                    visit(index, {});
+                }
+
+            } else {
+                str.remove_prefix(shortDelimiter.size());
+
+                if (str.empty()) {
+                    return fail(ArgParse::Error::Kind::InvalidOption, "");
+                }
+
+                for (size_t j = 0; j < str.size(); ++j) {
+                    auto slot = shortIndex_[static_cast<unsigned char>(str[j])];
+                    if (!slot) {
+                        return fail(ArgParse::Error::Kind::UnrecognizedOption, str.substr(j, 1));
+                    }
+
+                    auto index = slot - 1;
+                    if (info_[index].parameter.size()) {
+                        std::string_view arg{};
+                        if (j + 1 < str.size()) {
+                            visit(index, str.substr(j + 1));
+                        } else if (next(arg)) {
+                            visit(index, arg);
+                        } else {
+                            return fail(ArgParse::Error::Kind::RequiresArgument, str.substr(j, 1));
+                        }
+                        break;
+                    }
+
+                    visit(index, {});
+                }
+            }
+        }
+
+        return {};
+    }
+
+public:
+    constexpr StaticArgParse(StaticOption<Callbacks>... options)
+        : options_{options...}
+        , info_{static_cast<const StaticOptionInfo &>(options)...}
+        , shortIndex_{}
+        , longIndex_{}
+        , displacement_{}
+        , hashIndex_{}
+        , hashed_{}
+    {
+        for (size_t i = 0; i < size_; ++i) {
+            if (info_[i].shortName) {
+                auto &slot = shortIndex_[static_cast<unsigned char>(info_[i].shortName)];
+                if (!slot) {
+                    slot = i + 1;
+                }
+            }
+
+            // Insertion sort, keeping options having the same long name in the order added.
+            auto j = i;
+            for (; j > 0 && info_[i].longName < info_[longIndex_[j - 1]].longName; --j) {
+                longIndex_[j] = longIndex_[j - 1];
+            }
+            longIndex_[j] = i;
+        }
+
+        hashed_ = buildHash();
+    }
+
+    /// Parse argument list.
+    /// @discussion As ArgParse::process, except that callbacks receive option-arguments as views into @c argv.
+    /// The arguments are scanned twice: once to validate them and find the operands, and again to call the callbacks,
+    /// so that nothing is buffered.
+    /// @see ArgParse::process
+    auto process(int argc, char *const *argv, std::vector<std::string_view> &operands) const -> ArgParse::Error
+    {
+        operands.clear();
+
+        std::array<bool, size_> has{};
+        auto err = parse(argc, argv, &operands, [&](size_t index, std::string_view) { has[index] = true; });
+        if (err) {
+            return err;
+        }
+
+        for (size_t i = 0; i < size_; ++i) {
+            if (info_[i].required && !has[i]) {
+                return {ArgParse::Error::Kind::MissingOption, info_[i].name()};
+            }
+        }
+
+        parse(argc, argv, nullptr, [this](size_t index, std::string_view arg) {
+            dispatch(index, arg, std::index_sequence_for<Callbacks...>{});
+        });
+        return {};
+    }
+};
@@ -1,9 +1,102 @@
 #include "argparse.hpp"
+#include "static_argparse.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <set>
 #include <sstream>
+#include <thread>
+
+namespace
+{
+
+/// Number of calls to global operator new.
+std::atomic<size_t> allocations{};
+
+/// Paths of temporary files created by @c temporaryFile.
+std::vector<std::string> temporaryFiles;
+
+/// @return std::string Path of a new temporary file containing @c content.
+std::string temporaryFile(const std::string &content)
+{
+    char path[] = "/tmp/test_argparse.XXXXXX";
+    auto fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+
+    std::ofstream{path} << content;
+    temporaryFiles.push_back(path);
+    return path;
+}
+
+/// Memory resource which counts outstanding allocations, and fails once @c limit allocations have been made.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    size_t allocated{};
+    size_t outstanding{};
+    size_t limit{SIZE_MAX};
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        if (allocated == limit) {
+            throw std::bad_alloc{};
+        }
+        allocated++;
+        outstanding += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        outstanding -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+/// Options seen by the constant-initialized StaticArgParse.
+int staticVerbose{};
+std::string_view staticOutput{};
+
+} // namespace
+
+void *operator new(size_t size)
+{
+    allocations++;
+    if (auto p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
 
 int main()
 {
@@ -133,6 +226,7 @@ int main()
             argv = {"-"};
             error = a.process(argv);
             assert(error.kind == ArgParse::Error::Kind::InvalidOption);
+            assert(error.message() == "invalid option ''");
             assert(args.empty());
             assert(argv.empty());
 
@@ -184,14 +278,14 @@ int main()
             argv = {"-a", "-x"};
             error = a.process(argv);
             assert(error.kind == ArgParse::Error::Kind::UnrecognizedOption);
-            assert(error.message == "unrecognized option 'x'");
+            assert(error.message() == "unrecognized option 'x'");
             assert(args.empty());
             assert(argv.empty());
 
             argv = {"-a", "--unknown"};
             error = a.process(argv);
             assert(error.kind == ArgParse::Error::Kind::UnrecognizedOption);
-            assert(error.message == "unrecognized option 'unknown'");
+            assert(error.message() == "unrecognized option 'unknown'");
             assert(args.empty());
             assert(argv.empty());
         }
@@ -200,7 +294,7 @@ int main()
             std::vector<std::string> argv{"-c"};
             auto error = a.process(argv);
             assert(error.kind == ArgParse::Error::Kind::RequiresArgument);
-            assert(error.message == "option 'c' requires an argument");
+            assert(error.message() == "option 'c' requires an argument");
             assert(args.empty());
             assert(argv.empty());
 
@@ -220,14 +314,14 @@ int main()
             std::vector<std::string> argv{"--long-"};
             auto error = a.process(argv);
             assert(error.kind == ArgParse::Error::Kind::AmbiguousOption);
-            assert(error.message == "option 'long-' is ambiguous");
+            assert(error.message() == "option 'long-' is ambiguous");
             assert(args.empty());
             assert(argv.empty());
 
             argv = {"--long-c"};
             error = a.process(argv);
             assert(error.kind == ArgParse::Error::Kind::RequiresArgument);
-            assert(error.message == "option 'long-c-opt' requires an argument");
+            assert(error.message() == "option 'long-c-opt' requires an argument");
             assert(args.empty());
             assert(argv.empty());
 
@@ -250,7 +344,7 @@ int main()
             std::vector<std::string> argv{"--long-e=E"};
             auto error = a.process(argv);
             assert(error.kind == ArgParse::Error::Kind::UnexpectedArgument);
-            assert(error.message == "option 'long-e-opt' does not allow an argument");
+            assert(error.message() == "option 'long-e-opt' does not allow an argument");
             assert(args.empty());
             assert(argv.empty());
 
@@ -298,21 +392,21 @@ int main()
         auto error = a.process(argv);
         error = a.process(argv);
         assert(error.kind == ArgParse::Error::Kind::MissingOption);
-        assert(error.message == "missing required option 'd'");
+        assert(error.message() == "missing required option 'd'");
         assert(args.empty());
         assert(argv.empty());
 
         argv = {"-ad"};
         error = a.process(argv);
         assert(error.kind == ArgParse::Error::Kind::RequiresArgument);
-        assert(error.message == "option 'd' requires an argument");
+        assert(error.message() == "option 'd' requires an argument");
         assert(args.empty());
         assert(argv.empty());
 
         argv = {"-adx"};
         error = a.process(argv);
         assert(error.kind == ArgParse::Error::Kind::MissingOption);
-        assert(error.message == "missing required option 'long-f'");
+        assert(error.message() == "missing required option 'long-f'");
         assert(args.empty());
         assert(argv.empty());
 
@@ -333,4 +427,1724 @@ int main()
         args.clear();
         assert(argv.empty());
     }
+
+    {
+        ArgParse a;
+
+        std::vector<std::string> seen;
+        for (auto name : {"zeta", "alpha", "beta", "alphabet", "gamma", "delta-x", "delta-y"}) {
+            a.add({}, name, "Describe", [&seen, name]() { seen.push_back(name); });
+        }
+
+        std::vector<std::string> argv{"--zeta", "--alphab", "--b", "--g", "--delta-y"};
+        auto error = a.process(argv);
+        assert(!error);
+        assert(seen == (std::vector<std::string>{"zeta", "alphabet", "beta", "gamma", "delta-y"}));
+        seen.clear();
+
+        // An exact match is still ambiguous if it is also a prefix of another option.
+        argv = {"--alpha"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::AmbiguousOption);
+        assert(error.message() == "option 'alpha' is ambiguous");
+
+        argv = {"--delta"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::AmbiguousOption);
+
+        for (auto name : {"alphz", "betaa", "eta", "zz", "delta-z"}) {
+            argv = {std::string{"--"} + name};
+            error = a.process(argv);
+            assert(error.kind == ArgParse::Error::Kind::UnrecognizedOption);
+        }
+        assert(seen.empty());
+    }
+
+    {
+        ArgParse a;
+
+        std::vector<int> seen;
+        for (int i = 0; i < 500; ++i) {
+            auto name = "option-" + std::to_string(i * 7919 % 500);
+            a.add({}, name.c_str(), "Describe", [&seen, i]() { seen.push_back(i); });
+        }
+
+        std::vector<std::string> argv{"--option-499", "--option-0", "--option-4"};
+        auto error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::AmbiguousOption);
+        assert(error.message() == "option 'option-4' is ambiguous");
+        assert(seen.empty());
+
+        argv = {"--option-499", "--option-0", "--option-42"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::AmbiguousOption);
+
+        argv = {"--option-499", "--option-0", "--option-421"};
+        error = a.process(argv);
+        assert(!error);
+        assert(seen.size() == 3);
+        assert(seen[0] * 7919 % 500 == 499);
+        assert(seen[1] * 7919 % 500 == 0);
+        assert(seen[2] * 7919 % 500 == 421);
+    }
+
+    {
+        ArgParse a;
+
+        std::vector<std::string> seen;
+        a.add('v', "", "Describe v", [&]() { seen.push_back("v1"); });
+        a.add('v', "", "Describe v", [&]() { seen.push_back("v2"); });
+        a.add('\xe9', "", "Describe e-acute", [&]() { seen.push_back("e"); });
+        a.add('x', "", "ARG", "Describe x", [&](const std::string &arg) { seen.push_back("x" + arg); });
+
+        // The first option added with a given option character is used.
+        std::vector<std::string> argv{"-vvv\xe9xvv", "-vx", "X"};
+        auto error = a.process(argv);
+        assert(!error);
+        assert(seen == (std::vector<std::string>{"v1", "v1", "v1", "e", "xvv", "v1", "xX"}));
+        seen.clear();
+
+        argv = {"-vvy"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::UnrecognizedOption);
+        assert(error.message() == "unrecognized option 'y'");
+
+        argv = {"-vvx"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::RequiresArgument);
+        assert(error.message() == "option 'x' requires an argument");
+        assert(seen.empty());
+    }
+
+    {
+        ArgParse a;
+
+        std::vector<std::string> seen;
+        a.add('v', "verbose", "Describe v", [&]() { seen.push_back("v"); });
+        a.add('o', "output", "FILE", "Describe o", [&](const std::string &arg) { seen.push_back("o" + arg); });
+
+        char arg0[] = "program", arg1[] = "one", arg2[] = "-vofile", arg3[] = "two", arg4[] = "--output",
+             arg5[] = "out", arg6[] = "--", arg7[] = "-v";
+        char *argv[] = {arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, nullptr};
+
+        std::vector<std::string_view> operands{"stale"};
+        auto error = a.process(8, argv, operands);
+        assert(!error);
+        assert(seen == (std::vector<std::string>{"v", "ofile", "oout"}));
+        seen.clear();
+        assert(operands.size() == 3);
+        assert(operands[0].data() == arg1);
+        assert(operands[1].data() == arg3);
+        assert(operands[2].data() == arg7);
+
+        error = a.process(1, argv, operands);
+        assert(!error);
+        assert(operands.empty());
+
+        error = a.process(5, argv, operands);
+        assert(error.kind == ArgParse::Error::Kind::RequiresArgument);
+        assert(error.message() == "option 'output' requires an argument");
+        assert(seen.empty());
+        assert(operands.size() == 2);
+
+        char arg8[] = "-x";
+        argv[4] = arg8;
+        error = a.process(8, argv, operands);
+        assert(error.kind == ArgParse::Error::Kind::UnrecognizedOption);
+        assert(seen.empty());
+        assert(operands.size() == 5);
+        assert(operands[2] == "out");
+        assert(operands[3] == "--");
+        assert(operands[4] == "-v");
+    }
+
+    {
+        ArgParse a;
+
+        size_t n{};
+        a.add('v', "", "Describe v", [&]() { n++; });
+
+        // Interleaved options and operands must be separated in linear time; erasing each option from the middle of
+        // argv would take minutes here.
+        const size_t count = 200000;
+        std::vector<std::string> argv;
+        for (size_t i = 0; i < count; ++i) {
+            argv.push_back(i % 2 ? std::to_string(i) : "-v");
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto error = a.process(argv);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        assert(!error);
+        assert(elapsed < std::chrono::seconds{2});
+        assert(n == count / 2);
+        assert(argv.size() == count / 2);
+        for (size_t i = 0; i < argv.size(); ++i) {
+            assert(argv[i] == std::to_string(2 * i + 1));
+        }
+
+        argv = {"", "-v", "", "--", "-v"};
+        error = a.process(argv);
+        assert(!error);
+        assert(argv == (std::vector<std::string>{"", "", "-v"}));
+    }
+
+    {
+        ArgParse::Error error;
+        assert(!error);
+        assert(error.message().empty());
+
+        error = ArgParse::Error{ArgParse::Error::Kind::MissingOption, "output"};
+        std::stringstream ss;
+        error.format(ss);
+        assert(ss.str() == "missing required option 'output'");
+        assert(error.message() == ss.str());
+    }
+
+    {
+        ArgParse a;
+
+        size_t n{};
+        a.add('v', "verbose", "Describe v", [&]() { n++; });
+
+        char arg0[] = "program", arg1[] = "-vvvvvvvv", arg2[] = "--verb", arg3[] = "operand";
+        char *argv[] = {arg0, arg1, arg2, arg3, nullptr};
+        std::vector<std::string_view> operands;
+
+        auto error = a.process(4, argv, operands);
+        assert(!error);
+        assert(n == 9);
+
+        // Once scratch storage has grown, a successful parse does not allocate.
+        size_t before = allocations;
+        error = a.process(4, argv, operands);
+        assert(allocations == before);
+        assert(!error);
+        assert(n == 18);
+        assert(operands.size() == 1);
+    }
+
+    {
+        static constexpr StaticArgParse parser{
+            StaticOption{'v', "verbose", []() { staticVerbose++; }},
+            StaticOption{'o', "output", "FILE", [](std::string_view arg) { staticOutput = arg; }, true},
+        };
+
+        char arg0[] = "program", arg1[] = "-vvofile", arg2[] = "operand", arg3[] = "--verb";
+        char *argv[] = {arg0, arg1, arg2, arg3, nullptr};
+        std::vector<std::string_view> operands;
+
+        auto error = parser.process(4, argv, operands);
+        assert(!error);
+        assert(staticVerbose == 3);
+
+        size_t before = allocations;
+        error = parser.process(4, argv, operands);
+        assert(allocations == before);
+        assert(!error);
+        assert(staticVerbose == 6);
+        assert(staticOutput.data() == arg1 + 4);
+        assert(operands.size() == 1);
+        assert(operands[0].data() == arg2);
+
+        error = parser.process(1, argv, operands);
+        assert(error.kind == ArgParse::Error::Kind::MissingOption);
+        assert(error.message() == "missing required option 'output'");
+        assert(staticVerbose == 6);
+    }
+
+    {
+        // StaticArgParse and ArgParse agree on the same option set.
+        std::vector<std::string> seen;
+        auto record = [&seen](const char *name) { return [&seen, name]() { seen.push_back(name); }; };
+        auto recordArg = [&seen](const char *name) {
+            return [&seen, name](std::string_view arg) { seen.push_back(name + std::string{"="} + std::string{arg}); };
+        };
+
+        const StaticArgParse parser{
+            StaticOption{'a', "", record("a")},
+            StaticOption{'b', "bravo", record("b")},
+            StaticOption{'b', "bravo-two", record("b2")},
+            StaticOption{'c', "charlie", "ARG", recordArg("c")},
+            StaticOption{{}, "delta", "ARG", recordArg("d"), true},
+            StaticOption{{}, "echo", record("e")},
+            StaticOption{{}, "echo-foxtrot", record("ef")},
+            StaticOption{'g', "golf", record("g")},
+        };
+
+        ArgParse a;
+        a.add('a', "", "", [&]() { seen.push_back("a"); });
+        a.add('b', "bravo", "", [&]() { seen.push_back("b"); });
+        a.add('b', "bravo-two", "", [&]() { seen.push_back("b2"); });
+        a.add('c', "charlie", "ARG", "", [&](const std::string &arg) { seen.push_back("c=" + arg); });
+        a.add({}, "delta", "ARG", "", [&](const std::string &arg) { seen.push_back("d=" + arg); }, true);
+        a.add({}, "echo", "", [&]() { seen.push_back("e"); });
+        a.add({}, "echo-foxtrot", "", [&]() { seen.push_back("ef"); });
+        a.add('g', "golf", "", [&]() { seen.push_back("g"); });
+
+        const std::vector<std::vector<std::string>> cases{
+            {"--delta=D"},
+            {"-abgc", "C", "x", "--delta", "D", "--", "-a"},
+            {"-acC", "--del=", "--golf", "--echo-", "y", "--charlie=1=2"},
+            {"--bravo", "--delta", "D"},
+            {"--bravo-t", "--delta", "D"},
+            {"--b", "--delta", "D"},
+            {"--echo", "--delta", "D"},
+            {"--gol=x", "--delta", "D"},
+            {"--e", "--delta", "D"},
+            {"--=", "--delta", "D"},
+            {"--zulu", "--delta", "D"},
+            {"-", "--delta", "D"},
+            {"-ax", "--delta", "D"},
+            {"x", "-c", "--delta", "D"},
+            {"-ac"},
+            {"--charlie"},
+            {"-ab"},
+            {},
+        };
+
+        for (const auto &args : cases) {
+            std::vector<std::string> argv{args};
+            auto expected = a.process(argv);
+            auto expectedSeen = seen;
+            seen.clear();
+
+            std::vector<char *> array{const_cast<char *>("program")};
+            for (const auto &arg : args) {
+                array.push_back(const_cast<char *>(arg.c_str()));
+            }
+            std::vector<std::string_view> operands;
+            auto error = parser.process(static_cast<int>(array.size()), array.data(), operands);
+
+            assert(error.kind == expected.kind);
+            assert(error.message() == expected.message());
+            assert(seen == expectedSeen);
+            assert(std::vector<std::string>(operands.begin(), operands.end()) == argv);
+            seen.clear();
+        }
+    }
+
+    {
+        ArgParse parser;
+
+        std::atomic<int> verbose{};
+        std::atomic<size_t> bytes{};
+        parser.add('v', "verbose", "Describe v", [&]() { verbose++; });
+        parser.add('o', "output", "FILE", "Describe o", [&](const std::string &arg) { bytes += arg.size(); }, true);
+
+        // One parser shared between threads, each with its own context.
+        const ArgParse &shared = parser;
+        const int iterations = 1000;
+        std::vector<std::thread> threads;
+        std::atomic<int> failures{};
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&shared, &failures, t]() {
+                ArgParse::Context context;
+                for (int i = 0; i < iterations; ++i) {
+                    auto missing = t == 0 && i % 2;
+                    std::vector<std::string> argv{"-vv", "operand"};
+                    if (!missing) {
+                        argv.push_back("--output=" + std::string(static_cast<size_t>(t), 'x'));
+                    }
+
+                    auto error = shared.process(context, argv);
+                    auto expected = missing ? ArgParse::Error::Kind::MissingOption : ArgParse::Error::Kind::None;
+                    if (error.kind != expected || argv != std::vector<std::string>{"operand"}) {
+                        failures++;
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        assert(failures == 0);
+        assert(verbose == 2 * (4 * iterations - iterations / 2));
+        assert(bytes == (1 + 2 + 3) * iterations);
+
+        ArgParse::Context context;
+        char arg0[] = "program", arg1[] = "-v";
+        char *argv[] = {arg0, arg1, nullptr};
+        std::vector<std::string_view> operands;
+        auto error = shared.process(context, 2, argv, operands);
+        assert(error.kind == ArgParse::Error::Kind::MissingOption);
+    }
+
+    {
+        ArgParse a;
+
+        std::vector<std::string> seen;
+        a.add('v', "verbose", "Describe v", [&]() { seen.push_back("v"); });
+        a.add('o', "output", "FILE", "Describe o", [&](const std::string &arg) { seen.push_back("o=" + arg); });
+
+        auto nested = temporaryFile("-v nested\n");
+        auto file = temporaryFile("  -v\t'a b' \"c\\\"d\" e\\ f ''\n-o\r\nout @" + nested + " --output\n");
+
+        // Response files are not expanded by default.
+        std::vector<std::string> argv{"@" + file, "@"};
+        auto error = a.process(argv);
+        assert(!error);
+        assert(argv == (std::vector<std::string>{"@" + file, "@"}));
+
+        a.expandResponseFiles();
+
+        argv = {"x", "@" + file, "O", "@", "y"};
+        error = a.process(argv);
+        assert(!error);
+        assert(seen == (std::vector<std::string>{"v", "o=out", "v", "o=O"}));
+        seen.clear();
+        assert(argv == (std::vector<std::string>{"x", "a b", "c\"d", "e f", "", "nested", "@", "y"}));
+
+        // Arguments read from response files view the mapped file.
+        ArgParse::Context context;
+        std::string arg1 = "@" + file, arg2 = "O";
+        char *args[] = {arg1.data(), arg1.data(), arg2.data(), nullptr};
+        std::vector<std::string_view> operands;
+        error = a.process(context, 3, args, operands);
+        assert(!error);
+        assert(operands.size() == 5);
+        assert(operands[0] == "a b");
+        assert(operands[3].empty());
+        assert(operands[4] == "nested");
+        seen.clear();
+
+        // A trailing backslash is kept.
+        argv = {"@" + temporaryFile("a\\")};
+        error = a.process(argv);
+        assert(!error);
+        assert(argv == (std::vector<std::string>{"a\\"}));
+
+        argv = {"@" + temporaryFile(""), "@" + temporaryFile(" \n ")};
+        error = a.process(argv);
+        assert(!error);
+        assert(argv.empty());
+
+        argv = {"-v", "@/nonexistent/file", "z"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::UnreadableResponseFile);
+        assert(error.message() == "cannot read response file '/nonexistent/file'");
+        assert(seen.empty());
+
+        argv = {"@/tmp"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::UnreadableResponseFile);
+
+        // The error reading a response file takes precedence over the missing option-argument.
+        argv = {"-o", "@/nonexistent/file"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::UnreadableResponseFile);
+
+        argv = {"-x", "@/nonexistent/file"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::UnrecognizedOption);
+
+        auto recursive = temporaryFile("");
+        std::ofstream{recursive} << "-v @" << recursive;
+        argv = {"@" + recursive};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::ResponseFileNesting);
+        assert(error.message() == "response file '" + recursive + "' is nested too deeply");
+        assert(seen.empty());
+
+        a.expandResponseFiles(1);
+        argv = {"@" + file};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::ResponseFileNesting);
+
+        a.expandResponseFiles(0);
+        argv = {"@" + file};
+        error = a.process(argv);
+        assert(!error);
+        assert(argv.size() == 1);
+    }
+
+    {
+        ArgParse a;
+        a.expandResponseFiles();
+
+        size_t n{};
+        a.add('v', "verbose", "Describe v", [&]() { n++; });
+
+        // A large response file of paths, interleaved with options.
+        const size_t count = 200000;
+        std::string content;
+        for (size_t i = 0; i < count; ++i) {
+            content += i % 100 ? "/path/to/some/file-" + std::to_string(i) + ".txt\n" : "--verbose\n";
+        }
+        auto file = temporaryFile(content);
+
+        std::string arg1 = "@" + file;
+        char *args[] = {arg1.data(), arg1.data(), nullptr};
+        std::vector<std::string_view> operands;
+        auto error = a.process(2, args, operands);
+        assert(!error);
+        assert(n == count / 100);
+        assert(operands.size() == count - count / 100);
+        assert(operands[0] == "/path/to/some/file-1.txt");
+        assert(operands.back() == "/path/to/some/file-" + std::to_string(count - 1) + ".txt");
+
+        std::vector<std::string> argv{"first", "@" + file, "last"};
+        error = a.process(argv);
+        assert(!error);
+        assert(argv.size() == count - count / 100 + 2);
+        assert(argv[1] == "/path/to/some/file-1.txt");
+        assert(argv.back() == "last");
+    }
+
+    {
+        auto dummy_handler = [](const std::string &) {};
+
+        ArgParse a;
+        a.add('a', "", "Describe A\n\nwith blank\n", []() {});
+        a.add('b', "", "ARG", "", dummy_handler, "dflt");
+        a.add({}, "long-c", "", "\n", dummy_handler, true);
+        a.add('d', "long-d", "PARAM", "Describe D\nOn two lines.", dummy_handler, "D");
+        a.add({}, "", "", []() {});
+
+        const std::string expected{"  -a                      Describe A\n"
+                                   "                          \n"
+                                   "                          with blank\n"
+                                   "  -b=ARG                  (default: 'dflt')\n"
+                                   "          --long-c          (required)\n"
+                                   "  -d,     --long-d=PARAM  Describe D\n"
+                                   "                          On two lines.  (default: 'D')\n"
+                                   "                        \n"};
+        assert(a.helpText() == expected);
+
+        std::stringstream ss;
+        a.help(ss);
+        assert(ss.str() == expected);
+
+        auto file = temporaryFile("");
+        auto fd = open(file.c_str(), O_WRONLY);
+        assert(a.help(fd));
+        close(fd);
+        std::ifstream in{file};
+        assert(std::string(std::istreambuf_iterator<char>{in}, {}) == expected);
+
+        assert(!a.help(-1));
+
+        // Adding an option renders again.
+        a.add('e', "", "", []() {});
+        assert(a.helpText() == expected + "  -e                    \n");
+
+        ArgParse b;
+        b.add({}, "", "One\nTwo", []() {}, "x");
+        assert(b.helpText() == "    One\n     Two  (default: 'x')\n");
+
+        ArgParse c;
+        assert(c.helpText().empty());
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Typed bindings.
+        enum class Color { Red, Green };
+
+        int count{};
+        int64_t size{};
+        double ratio{};
+        bool enabled{};
+        std::string_view name{};
+        Color color{Color::Red};
+        size_t calls{};
+
+        ArgParse a;
+        a.add('c', "count", "N", "Count.", count);
+        a.add('s', "size", "BYTES", "Size.", size, "0");
+        a.add('r', "ratio", "R", "Ratio.", ratio);
+        a.add('e', "enabled", "BOOL", "Enabled.", enabled);
+        a.add('n', "name", "NAME", "Name.", name, true);
+        a.add({}, "color", "COLOR", "Color.", color, {{"red", Color::Red}, {"green", Color::Green}}, "red");
+        a.add('x', "", "Flag.", [&]() { calls++; });
+
+        auto parse = [&](std::vector<const char *> args) {
+            std::vector<char *> argv{const_cast<char *>("program")};
+            for (auto arg : args) {
+                argv.push_back(const_cast<char *>(arg));
+            }
+            std::vector<std::string_view> operands;
+            return a.process(static_cast<int>(argv.size()), argv.data(), operands);
+        };
+
+        auto err = parse({"-c-42", "--size=9000000000", "-r", "2.5", "--enabled", "yes", "--name", "alpha",
+                          "--color=green", "-x"});
+        assert(!err);
+        assert(count == -42);
+        assert(size == 9000000000);
+        assert(ratio == 2.5);
+        assert(enabled);
+        assert(name == "alpha");
+        assert(color == Color::Green);
+        assert(calls == 1);
+
+        for (auto [arg, value] : {std::pair{"true", true}, {"false", false}, {"yes", true}, {"no", false},
+                                  {"on", true}, {"off", false}, {"1", true}, {"0", false}}) {
+            assert(!parse({"-n", "", "-e", arg}));
+            assert(enabled == value);
+        }
+        assert(name.empty());
+
+        // No callback is called and no variable is assigned if any option-argument is invalid.
+        count = 0;
+        err = parse({"-x", "-c", "7", "-n", "z", "-c", "7z"});
+        assert(err.kind == ArgParse::Error::Kind::InvalidValue);
+        assert(err.name == "count");
+        assert(err.value == "7z");
+        assert(err.message() == "invalid value '7z' for option 'count'");
+        assert(count == 0);
+        assert(calls == 1);
+
+        err = parse({"-n", "z", "--count="});
+        assert(err.kind == ArgParse::Error::Kind::InvalidValue && err.value.empty());
+
+        err = parse({"-n", "z", "-c", "2147483648"});
+        assert(err.kind == ArgParse::Error::Kind::OutOfRange);
+        assert(err.message() == "value '2147483648' for option 'count' is out of range");
+
+        err = parse({"-n", "z", "-s", "x"});
+        assert(err.kind == ArgParse::Error::Kind::InvalidValue && err.name == "size");
+        err = parse({"-n", "z", "-s", "9223372036854775808"});
+        assert(err.kind == ArgParse::Error::Kind::OutOfRange);
+
+        err = parse({"-n", "z", "-r", "1.5.0"});
+        assert(err.kind == ArgParse::Error::Kind::InvalidValue && err.name == "ratio");
+        err = parse({"-n", "z", "-r", "1e999"});
+        assert(err.kind == ArgParse::Error::Kind::OutOfRange);
+
+        err = parse({"-n", "z", "-e", "maybe"});
+        assert(err.kind == ArgParse::Error::Kind::InvalidValue && err.name == "enabled");
+
+        err = parse({"-n", "z", "--color", "blue"});
+        assert(err.kind == ArgParse::Error::Kind::InvalidValue);
+        assert(err.message() == "invalid value 'blue' for option 'color'");
+        assert(color == Color::Green);
+
+        err = parse({"-c", "1"});
+        assert(err.kind == ArgParse::Error::Kind::MissingOption && err.name == "name");
+
+        assert(a.helpText() == "  -c, --count=N       Count.\n"
+                               "  -s, --size=BYTES    Size.  (default: '0')\n"
+                               "  -r, --ratio=R       Ratio.\n"
+                               "  -e, --enabled=BOOL  Enabled.\n"
+                               "  -n, --name=NAME     Name.  (required)\n"
+                               "      --color=COLOR   Color.  (default: 'red')\n"
+                               "  -x                  Flag.\n");
+
+        // Parsing typed bindings does not allocate.
+        std::vector<char *> argv{const_cast<char *>("program"), const_cast<char *>("-c3"),
+                                 const_cast<char *>("-n"), const_cast<char *>("b")};
+        std::vector<std::string_view> operands;
+        assert(!a.process(static_cast<int>(argv.size()), argv.data(), operands));
+        size_t before = allocations;
+        assert(!a.process(static_cast<int>(argv.size()), argv.data(), operands));
+        assert(allocations == before);
+        assert(count == 3 && name == "b");
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Incremental parsing.
+        using Kind = ArgParse::Event::Kind;
+
+        size_t calls{};
+        int level{};
+
+        ArgParse a;
+        auto verbose = a.add('v', "verbose", "Verbose.", [&]() { calls++; });
+        auto output = a.add('o', "output", "FILE", "Output.", [&](const std::string &) { calls++; }, true);
+        auto levelId = a.add('l', "level", "N", "Level.", level);
+        assert(verbose == 0 && output == 1 && levelId == 2);
+
+        std::vector<char *> argv{const_cast<char *>("program"), const_cast<char *>("-vofile"),
+                                 const_cast<char *>("in"), const_cast<char *>("--level"),
+                                 const_cast<char *>("5"), const_cast<char *>("--"),
+                                 const_cast<char *>("-v")};
+
+        ArgParse::Context context;
+        ArgParse::Parser parser{a, context, static_cast<int>(argv.size()), argv.data()};
+
+        auto event = parser.next();
+        assert(event.kind == Kind::Option && event.id == verbose && event.arg.empty());
+        event = parser.next();
+        assert(event.kind == Kind::Option && event.id == output && event.arg == "file");
+        assert(event.arg.data() == argv[1] + 3);
+        event = parser.next();
+        assert(event.kind == Kind::Operand && event.arg == "in");
+
+        // Nothing is called until dispatched.
+        assert(calls == 0);
+        event = parser.next();
+        assert(event.kind == Kind::Option && event.id == levelId && event.arg == "5");
+        assert(!a.dispatch(event));
+        assert(level == 5);
+
+        event = parser.next();
+        assert(event.kind == Kind::Operand && event.arg == "-v");
+        event = parser.next();
+        assert(event.kind == Kind::End);
+        assert(!a.dispatch(event));
+        assert(parser.next().kind == Kind::End);
+        assert(calls == 0);
+
+        // Conversion errors are reported by dispatch.
+        event = ArgParse::Event{Kind::Option, levelId, "x", {}};
+        auto err = a.dispatch(event);
+        assert(err.kind == ArgParse::Error::Kind::InvalidValue && err.name == "level" && err.value == "x");
+
+        // Errors end the parse.
+        std::vector<char *> bad{const_cast<char *>("program"), const_cast<char *>("-vz"), const_cast<char *>("in")};
+        ArgParse::Parser badParser{a, context, static_cast<int>(bad.size()), bad.data()};
+        assert(badParser.next().kind == Kind::Option);
+        event = badParser.next();
+        assert(event.kind == Kind::Error);
+        assert(event.error.kind == ArgParse::Error::Kind::UnrecognizedOption && event.error.name == "z");
+        assert(badParser.next().kind == Kind::End);
+
+        // Required options are checked at the end.
+        ArgParse::Parser missing{a, context, 1, argv.data()};
+        event = missing.next();
+        assert(event.kind == Kind::Error);
+        assert(event.error.kind == ArgParse::Error::Kind::MissingOption && event.error.name == "output");
+        assert(missing.next().kind == Kind::End);
+
+        // Parsing does not allocate once the context has been used.
+        size_t before = allocations;
+        ArgParse::Parser again{a, context, static_cast<int>(argv.size()), argv.data()};
+        size_t events{};
+        while (again.next().kind != Kind::End) {
+            events++;
+        }
+        assert(events == 5);
+        assert(allocations == before);
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Commands.
+        std::vector<std::string> trace;
+        size_t built{};
+        int jobs{};
+        std::string commandHelp;
+
+        ArgParse a;
+        a.add('v', "verbose", "Verbose.", [&]() { trace.push_back("verbose"); });
+        a.add('o', "output", "FILE", "Output.", [&](const std::string &arg) { trace.push_back("output " + arg); });
+        a.addCommand("build", "Build targets.", [&](ArgParse &cmd) {
+            built++;
+            cmd.add('j', "jobs", "N", "Jobs.", jobs);
+            cmd.add('h', "help", "Help.", [&]() { commandHelp = cmd.helpText(); });
+            cmd.add('k', "keep", "Keep going.", [&]() { trace.push_back("keep"); });
+        });
+        a.addCommand("remote", "Manage remotes.\nOn two lines.", [&](ArgParse &cmd) {
+            built++;
+            cmd.add('n', "dry-run", "Dry run.", [&]() { trace.push_back("dry-run"); });
+            cmd.addCommand("add", "Add a remote.", [&](ArgParse &add) {
+                add.add('f', "fetch", "Fetch.", [&]() { trace.push_back("fetch"); });
+            });
+        });
+
+        assert(a.helpText() == "  -v, --verbose      Verbose.\n"
+                               "  -o, --output=FILE  Output.\n"
+                               "\n"
+                               "  build   Build targets.\n"
+                               "  remote  Manage remotes.\n"
+                               "          On two lines.\n");
+        assert(built == 0);
+
+        // Options before the command are dispatched first, and only the selected command is built.
+        std::vector<std::string> args{"-v", "build", "-kj", "4", "all", "-h", "--", "-v"};
+        assert(!a.process(args));
+        assert(built == 1);
+        assert(jobs == 4);
+        assert((trace == std::vector<std::string>{"verbose", "keep"}));
+        assert((args == std::vector<std::string>{"all", "-v"}));
+        assert(commandHelp == "  -j, --jobs=N  Jobs.\n"
+                              "  -h, --help    Help.\n"
+                              "  -k, --keep    Keep going.\n");
+
+        // Nested commands.
+        trace.clear();
+        args = {"remote", "-n", "add", "-f", "origin", "--output=x"};
+        auto err = a.process(args);
+        assert(err.kind == ArgParse::Error::Kind::UnrecognizedOption);
+        assert(err.name == "output" && err.command == "remote add");
+        assert(err.message() == "unrecognized option 'output'");
+        assert(trace.empty());
+
+        args = {"-o", "x", "remote", "-n", "add", "-f", "origin"};
+        assert(!a.process(args));
+        assert((trace == std::vector<std::string>{"output x", "dry-run", "fetch"}));
+        assert((args == std::vector<std::string>{"origin"}));
+
+        // Errors name the command.
+        trace.clear();
+        args = {"-v", "build", "--jobs=many"};
+        err = a.process(args);
+        assert(err.kind == ArgParse::Error::Kind::InvalidValue && err.command == "build");
+        assert(trace.empty());
+
+        args = {"-v", "bulid", "x"};
+        err = a.process(args);
+        assert(err.kind == ArgParse::Error::Kind::UnrecognizedCommand && err.name == "bulid");
+        assert(err.command.empty());
+        assert(err.message() == "unrecognized command 'bulid'");
+        assert((args == std::vector<std::string>{"x"}));
+
+        // Operands after "--" do not select a command.
+        trace.clear();
+        built = 0;
+        args = {"--", "build", "-k", "x"};
+        assert(!a.process(args));
+        assert(built == 0 && trace.empty());
+        assert((args == std::vector<std::string>{"build", "-k", "x"}));
+
+        args = {"-v", "--", "file.txt"};
+        assert(!a.process(args));
+        assert((trace == std::vector<std::string>{"verbose"}));
+        assert((args == std::vector<std::string>{"file.txt"}));
+
+        // No command is required, but one selected after the options are checked.
+        args = {"-v"};
+        assert(!a.process(args));
+
+        ArgParse b;
+        b.add('r', "required", "R", "Required.", [](const std::string &) {}, true);
+        b.addCommand("run", "Run.", [](ArgParse &) {});
+        assert(b.helpText() == "  -r, --required=R  Required.  (required)\n\n  run  Run.\n");
+        args = {"run"};
+        err = b.process(args);
+        assert(err.kind == ArgParse::Error::Kind::MissingOption && err.command.empty());
+
+        ArgParse c;
+        c.addCommand("only", "", [](ArgParse &) {});
+        assert(c.helpText() == "  only\n");
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Instrumentation.
+        std::string output;
+        int level{};
+
+        ArgParse a;
+        a.add('v', "verbose", "Verbose.", []() {});
+        a.add('o', "output", "FILE", "Output.", [&](const std::string &arg) { output = arg; }, true);
+        a.add('l', "level", "N", "Level.", level);
+        a.addCommand("run", "Run.", [](ArgParse &cmd) { cmd.add('f', "force", "Force.", []() {}); });
+
+        // Counters start at zero without value-initialization.
+        ArgParse::Stats stats;
+        a.instrument(&stats);
+
+        const std::string path(64, 'p');
+        std::vector<std::string> args{"-vo", path, "--level=3", "--verb", "run", "-f", "x", "y"};
+        assert(!a.process(args));
+        assert(output == path && level == 3);
+        assert(stats.parses == 1);
+        assert(stats.options == 5);
+        assert(stats.operands == 2);
+        assert(stats.longLookups == 2);
+        assert(stats.shortLookups == 3);
+        assert(stats.dispatched == 5);
+        assert(stats.bytesAllocated > path.size());
+
+        // A second parse reuses storage, and accumulates.
+        auto bytes = stats.bytesAllocated;
+        args = {"-o", "out", "-l", "2"};
+        assert(!a.process(args));
+        assert(stats.parses == 2 && stats.options == 7 && stats.shortLookups == 5);
+        assert(stats.bytesAllocated == bytes);
+
+        args = {"-l", "high", "-o", "out"};
+        assert(a.process(args));
+        args = {"run"};
+        assert(a.process(args));
+        assert(stats.parses == 4);
+
+        std::stringstream ss;
+        stats.dump(ss);
+        auto text = ss.str();
+        assert(text.find("parses: 4\n") == 0);
+        assert(text.find("\nshort lookups: 7\n") != std::string::npos);
+        assert(text.find("\ndispatch: ") != std::string::npos);
+        assert(std::count(text.begin(), text.end(), '\n') == 12);
+
+        // Stop instrumenting.
+        a.instrument(nullptr);
+        args = {"-o", "out"};
+        assert(!a.process(args));
+        assert(stats.parses == 4);
+
+        // Caller-owned contexts are instrumented separately.
+        ArgParse::Stats contextStats{};
+        ArgParse::Context context;
+        context.instrument(&contextStats);
+        args = {"-o", "out", "run", "--force", "a"};
+        assert(!a.process(context, args));
+        assert(contextStats.parses == 1 && contextStats.options == 2 && contextStats.operands == 1);
+        assert(stats.parses == 4);
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Storage allocated from a memory resource.
+        alignas(std::max_align_t) static char buffer[64 * 1024];
+        std::pmr::monotonic_buffer_resource arena{buffer, sizeof(buffer), std::pmr::null_memory_resource()};
+
+        size_t verbose{};
+        std::string_view output;
+
+        std::vector<char *> argv{const_cast<char *>("program"), const_cast<char *>("-vvv"),
+                                 const_cast<char *>("--output-with=file"), const_cast<char *>("--verbose")};
+        std::vector<std::string_view> operands;
+        operands.reserve(4);
+
+        // Neither registration nor parsing allocates from the global heap.
+        size_t before = allocations;
+        {
+            ArgParse a{&arena};
+            a.add('v', "verbose-with-a-long-name", "Describe verbose, at more length than a short string holds.",
+                  [&verbose]() { verbose++; });
+            a.add('o', "output-with-a-long-name", "FILE", "Describe output, at more length than a short string holds.",
+                  output, "default-with-a-long-value");
+            a.addCommand("command-with-a-long-name", "Describe command, at more length than a short string holds.",
+                         [](ArgParse &) {});
+
+            assert(!a.process(static_cast<int>(argv.size()), argv.data(), operands));
+            assert(verbose == 4 && output == "file");
+
+            ArgParse::Context context{&arena};
+            assert(!a.process(context, static_cast<int>(argv.size()), argv.data(), operands));
+            assert(verbose == 8);
+        }
+        assert(allocations == before);
+
+        // Help is rendered into the resource.
+        CountingResource counting;
+        {
+            ArgParse a{&counting};
+            a.add('v', "verbose", "Verbose.", []() {});
+            auto outstanding = counting.outstanding;
+            assert(a.helpText() == "  -v, --verbose  Verbose.\n");
+            assert(counting.outstanding > outstanding);
+        }
+        assert(counting.outstanding == 0);
+
+        // Storage is released if construction fails.
+        CountingResource failing;
+        failing.limit = 1;
+        auto threw = false;
+        try {
+            ArgParse a{&failing};
+        } catch (const std::bad_alloc &) {
+            threw = true;
+        }
+        assert(threw);
+        assert(failing.allocated == 1 && failing.outstanding == 0);
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Callbacks are held inline.
+        struct Counted {
+            int *calls;
+            int *live;
+
+            Counted(int *c, int *l) : calls{c}, live{l}
+            {
+                (*live)++;
+            }
+            Counted(const Counted &other) noexcept : calls{other.calls}, live{other.live}
+            {
+                (*live)++;
+            }
+            ~Counted()
+            {
+                (*live)--;
+            }
+            void operator()() const
+            {
+                (*calls)++;
+            }
+        };
+
+        int calls{};
+        int live{};
+        {
+            ArgParse::Callback<void()> empty;
+            assert(!empty);
+
+            ArgParse::Callback<void()> f{Counted{&calls, &live}};
+            assert(f && live == 1);
+            auto g = f;
+            assert(live == 2);
+            auto h = std::move(g);
+            assert(live == 3);
+            g = h;
+            h = std::move(f);
+            g = g;
+            g = std::move(g);
+            assert(live == 3);
+            f = empty;
+            assert(!f && live == 2);
+            g();
+            h();
+            assert(calls == 2);
+        }
+        assert(live == 0);
+
+        // Callbacks are moved, not copied, as the table of options grows.
+        static_assert(std::is_nothrow_move_constructible_v<ArgParse::Callback<void()>>);
+        struct Copied {
+            int *copies;
+
+            explicit Copied(int *c) : copies{c}
+            {
+            }
+            Copied(const Copied &other) noexcept : copies{other.copies}
+            {
+                (*copies)++;
+            }
+            Copied(Copied &&other) noexcept = default;
+            void operator()() const
+            {
+            }
+        };
+
+        int copies{};
+        {
+            ArgParse grown;
+            for (int i = 0; i < 1000; ++i) {
+                grown.add({}, std::to_string(i).c_str(), "Describe.", Copied{&copies});
+            }
+        }
+        assert(copies == 0);
+
+        alignas(std::max_align_t) static char buffer[256 * 1024];
+        std::pmr::monotonic_buffer_resource arena{buffer, sizeof(buffer), std::pmr::null_memory_resource()};
+
+        // A callable too large to hold inline is held by reference.
+        struct Large {
+            int values[64];
+            int *sum;
+            void operator()(const std::string &arg)
+            {
+                *sum += values[0] + static_cast<int>(arg.size());
+            }
+        };
+
+        int sum{};
+        Large large{{10}, &sum};
+        std::function<void()> function{[&calls]() { calls += 100; }};
+
+        std::vector<char *> argv{const_cast<char *>("program"), const_cast<char *>("-a"), const_cast<char *>("-l"),
+                                 const_cast<char *>("xy"), const_cast<char *>("-f"), const_cast<char *>("-mslow")};
+        std::vector<std::string_view> operands;
+        operands.reserve(4);
+
+        // Neither registration nor dispatch allocates, even for lambdas with several captures and enumerators.
+        size_t before = allocations;
+        {
+            ArgParse a{&arena};
+            int *p1{&calls}, *p2{&calls}, *p3{&calls}, *p4{&calls}, *p5{&calls}, *p6{&calls};
+            a.add('a', "", "Six captures.", [p1, p2, p3, p4, p5, p6]() { *p1 += p2 == p3 && p4 == p5 && p6; });
+            a.add('l', "", "ARG", "Large.", std::ref(large));
+            a.add('f', "", "Function.", function);
+            enum class Mode { Fast, Slow };
+            Mode mode{Mode::Fast};
+            a.add('m', "", "MODE", "Mode.", mode, {{"fast", Mode::Fast}, {"slow", Mode::Slow}});
+            for (int i = 0; i < 100; ++i) {
+                a.add({}, "", "Counted.", Counted{&calls, &live});
+            }
+            assert(live == 100);
+
+            assert(!a.process(static_cast<int>(argv.size()), argv.data(), operands));
+            assert(mode == Mode::Slow);
+        }
+        assert(allocations == before);
+        assert(live == 0);
+        assert(calls == 103 && sum == 12);
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Strings are copied, unless they are viewed.
+        char name[] = "alpha";
+        char description[] = "Describe alpha.";
+
+        ArgParse a;
+        a.add('a', name, description, []() {});
+        a.copyStrings(false);
+        a.add('b', name, description, []() {});
+        a.copyStrings(true);
+        a.add('c', "", "", []() {});
+
+        name[0] = 'A';
+        description[0] = 'd';
+        assert(a.helpText() == "  -a, --alpha  Describe alpha.\n"
+                               "  -b, --Alpha  describe alpha.\n"
+                               "  -c         \n");
+
+        // Viewed strings are not allocated.
+        const char *text = "Describe an option at greater length than fits in a short string.";
+        CountingResource copied;
+        CountingResource viewed;
+        {
+            ArgParse c{&copied};
+            ArgParse v{&viewed};
+            v.copyStrings(false);
+            for (auto ap : {&c, &v}) {
+                ap->add('o', "option-with-a-long-name", "PARAMETER", text, [](const std::string &) {}, "default");
+                ap->addCommand("command-with-a-long-name", text, [](ArgParse &) {});
+            }
+            assert(viewed.outstanding + 2 * std::string_view{text}.size() < copied.outstanding);
+        }
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Abbreviations resolve as a scan of every long name would resolve them.
+        std::vector<std::string> names{"a",
+                                       "ab",
+                                       "abcdefg",
+                                       "abcdefgh",
+                                       "abcdefghi",
+                                       "abcdefghij",
+                                       "abcdefgz",
+                                       "config.alpha",
+                                       "config.alpha.beta",
+                                       "config.beta",
+                                       "configx",
+                                       "z\xe9ta",
+                                       "z\x7f"};
+
+        ArgParse a;
+        std::string seen;
+        a.add('q', "", "Describe", [&seen]() { seen = "q"; });
+        for (const auto &name : names) {
+            a.add({}, name.c_str(), "Describe", [&seen, &name]() { seen = name; });
+        }
+
+        std::vector<std::string> queries{std::string{"a\0", 2}, std::string{"abcdefgh\0", 9}};
+        for (const auto &name : names) {
+            for (size_t n = 1; n <= name.size(); ++n) {
+                queries.push_back(name.substr(0, n));
+            }
+            queries.push_back(name + "x");
+            queries.push_back(name.substr(0, name.size() - 1) + static_cast<char>(name.back() + 1));
+        }
+
+        for (const auto &query : queries) {
+            std::vector<std::string> matches;
+            for (const auto &name : names) {
+                if (name.compare(0, query.size(), query) == 0) {
+                    matches.push_back(name);
+                }
+            }
+
+            seen.clear();
+            std::vector<std::string> argv{"--" + query};
+            auto error = a.process(argv);
+            if (matches.size() == 1) {
+                assert(!error);
+                assert(seen == matches.front());
+            } else {
+                assert(error.kind == (matches.empty() ? ArgParse::Error::Kind::UnrecognizedOption
+                                                      : ArgParse::Error::Kind::AmbiguousOption));
+                assert(seen.empty());
+            }
+        }
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        ArgParse a;
+
+        std::vector<std::string> includes{"first"};
+        std::vector<std::string_view> defines;
+        int level{};
+        a.add('I', "include", "DIR", "Add include directory.", includes);
+        a.add('D', "define", "NAME", "Define macro.", defines, true);
+        a.add('O', "", "LEVEL", "Optimization level.", level);
+
+        // Every occurrence is appended, in argument order.
+        std::vector<std::string> args{"program", "-Ia", "--define=X", "-I", "b", "-O2", "-DY", "op",
+                                      "--include", "a-directory-name-too-long-for-the-small-string-buffer"};
+        std::vector<char *> argv;
+        for (auto &arg : args) {
+            argv.push_back(arg.data());
+        }
+        std::vector<std::string_view> operands;
+        assert(!a.process(static_cast<int>(argv.size()), argv.data(), operands));
+        assert(includes == (std::vector<std::string>{"first", "a", "b",
+                                                     "a-directory-name-too-long-for-the-small-string-buffer"}));
+        assert(defines == (std::vector<std::string_view>{"X", "Y"}));
+        assert(level == 2);
+        assert(operands == std::vector<std::string_view>{"op"});
+
+        // A required collecting option must be given at least once.
+        std::vector<std::string> missing{"-Ic"};
+        auto error = a.process(missing);
+        assert(error.kind == ArgParse::Error::Kind::MissingOption);
+        assert(error.name == "define");
+        assert(includes.size() == 4);
+
+        // Occurrences are counted while parsing, so collecting views allocates once in total.
+        args = {"program"};
+        for (int i = 0; i < 1000; ++i) {
+            args.push_back("-D" + std::to_string(i));
+        }
+        argv.clear();
+        for (auto &arg : args) {
+            argv.push_back(arg.data());
+        }
+        operands.clear();
+        assert(!a.process(static_cast<int>(argv.size()), argv.data(), operands));
+        std::vector<std::string_view>{}.swap(defines);
+
+        size_t before = allocations;
+        assert(!a.process(static_cast<int>(argv.size()), argv.data(), operands));
+        assert(allocations == before + 1);
+        assert(defines.size() == 1000 && defines.capacity() == 1000);
+        assert(defines.front() == "0" && defines.back() == "999");
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        ArgParse a;
+
+        std::string output;
+        auto json = a.add({}, "json", "Write JSON.", [&output]() { output += "json"; });
+        auto yaml = a.add({}, "yaml", "Write YAML.", [&output]() { output += "yaml"; });
+        auto xml = a.add('x', "", "Write XML.", [&output]() { output += "xml"; });
+        auto quiet = a.add('q', "quiet", "Write nothing.", []() {});
+        auto verbose = a.add('v', "verbose", "Write more.", []() {});
+        std::string_view user, password, host;
+        auto userId = a.add('u', "user", "NAME", "User name.", user);
+        auto passwordId = a.add('p', "password", "WORD", "Password.", password);
+        auto hostId = a.add('h', "host", "HOST", "Host name.", host);
+
+        a.constrain(ArgParse::Constraint::ExactlyOne, {json, yaml, xml});
+        a.constrain(ArgParse::Constraint::AtMostOne, {quiet, verbose});
+        a.constrain(ArgParse::Constraint::Requires, {userId, passwordId, hostId});
+        a.constrain(ArgParse::Constraint::Requires, {});
+
+        std::vector<std::string> argv{"--yaml", "-q", "-u", "me", "-p", "pw", "-h", "there"};
+        assert(!a.process(argv));
+        assert(output == "yaml");
+
+        argv = {"--json", "-x"};
+        auto error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::ConflictingOptions);
+        assert(error.name == "json" && error.other == "x");
+        assert(error.message() == "options 'json' and 'x' cannot be used together");
+
+        argv = {"-q"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::MissingOneOf);
+        assert(error.name == "json|yaml|x");
+        assert(error.message() == "missing one of options 'json|yaml|x'");
+
+        argv = {"-x", "--verbose", "-q"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::ConflictingOptions);
+        assert(error.name == "quiet" && error.other == "verbose");
+
+        argv = {"-x", "-p", "pw"};
+        assert(!a.process(argv));
+
+        argv = {"-x", "-u", "me", "-h", "there"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::MissingDependency);
+        assert(error.name == "user" && error.other == "password");
+        assert(error.message() == "option 'user' requires option 'password'");
+
+        // Constraints are checked after required options, and no callback is called if one fails.
+        output.clear();
+        a.add({}, "input", "FILE", "Input.", user, true);
+        argv = {"--json", "--yaml"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::MissingOption);
+        argv = {"--json", "--yaml", "--input", "in"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::ConflictingOptions);
+        assert(output.empty());
+
+        // The incremental parser reports a failed constraint at the end of the arguments.
+        std::vector<const char *> args{"program", "--input", "in"};
+        ArgParse::Context context;
+        ArgParse::Parser parser{a, context, static_cast<int>(args.size()), const_cast<char *const *>(args.data())};
+        assert(parser.next().kind == ArgParse::Event::Kind::Option);
+        auto event = parser.next();
+        assert(event.kind == ArgParse::Event::Kind::Error);
+        assert(event.error.kind == ArgParse::Error::Kind::MissingOneOf);
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Constraints and required options spanning several words of the bitmask.
+        ArgParse a;
+
+        std::vector<std::string> names;
+        for (int i = 0; i < 200; ++i) {
+            names.push_back("option-" + std::to_string(i));
+        }
+        std::vector<size_t> ids;
+        std::string_view value;
+        for (int i = 0; i < 200; ++i) {
+            ids.push_back(i % 50 == 49 ? a.add({}, names[i].c_str(), "ARG", "Required.", value, true)
+                                       : a.add({}, names[i].c_str(), "Describe.", []() {}));
+        }
+        a.constrain(ArgParse::Constraint::AtMostOne, {ids[3], ids[150], ids[190]});
+        a.constrain(ArgParse::Constraint::Requires, {ids[110], ids[70], ids[140]});
+
+        std::vector<std::string> argv{"--option-49=a", "--option-99=b", "--option-149=c"};
+        auto error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::MissingOption);
+        assert(error.name == "option-199");
+
+        argv = {"--option-49=a", "--option-99=b", "--option-149=c", "--option-199=d", "--option-190", "--option-150"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::ConflictingOptions);
+        assert(error.name == "option-150" && error.other == "option-190");
+
+        argv = {"--option-49=a", "--option-99=b", "--option-149=c", "--option-199=d", "--option-110", "--option-70"};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::MissingDependency);
+        assert(error.name == "option-110" && error.other == "option-140");
+
+        argv = {"--option-49=a", "--option-99=b", "--option-149=c", "--option-199=d", "--option-110", "--option-70",
+                "--option-140"};
+        assert(!a.process(argv));
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Constraints of a command are checked when its arguments have been parsed.
+        ArgParse a;
+        a.addCommand("run", "Run.", [](ArgParse &command) {
+            auto fast = command.add('f', "fast", "Fast.", []() {});
+            auto slow = command.add('s', "slow", "Slow.", []() {});
+            command.constrain(ArgParse::Constraint::AtMostOne, {fast, slow});
+        });
+
+        std::vector<std::string> argv{"run", "-fs"};
+        auto error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::ConflictingOptions);
+        assert(error.command == "run");
+        assert(error.name == "fast" && error.other == "slow");
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        ArgParse a;
+
+        // Each independent callback waits until all four have started, which happens only if they run concurrently.
+        std::mutex mutex;
+        std::condition_variable cv;
+        int started{};
+        std::atomic<int> concurrent{};
+        auto rendezvous = [&]() {
+            std::unique_lock<std::mutex> lock{mutex};
+            started++;
+            cv.notify_all();
+            concurrent += cv.wait_for(lock, std::chrono::seconds{10}, [&]() { return started == 4; });
+        };
+
+        std::vector<std::string> order;
+        std::vector<std::string> files;
+        size_t last{};
+        for (auto name : {"load-model", "open-database", "read-certificate", "warm-cache"}) {
+            last = a.add({}, name, "Describe.", rendezvous);
+            a.independent(last);
+        }
+        a.add('a', "", "Describe.", [&order]() { order.push_back("a"); });
+        a.add('b', "", "ARG", "Describe.", [&order](const std::string &arg) { order.push_back("b" + arg); });
+        auto file = a.add('f', "", "FILE", "Describe.", files);
+        a.independent(file);
+        a.independent(last);
+
+        std::vector<std::string> argv{"--load", "-b1", "--open", "-f1", "--read", "-a", "--warm", "-f2", "-b2"};
+        assert(!a.process(argv));
+        assert(concurrent == 4);
+        // Other options are still dispatched in argument order.
+        assert(order == (std::vector<std::string>{"b1", "a", "b2"}));
+        assert(files == (std::vector<std::string>{"1", "2"}));
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        ArgParse a;
+
+        std::atomic<int> calls{};
+        auto count = [&calls]() { calls++; };
+        a.independent(a.add('x', "", "Describe.", count));
+        a.independent(a.add('y', "", "Describe.", count));
+        a.independent(a.add('e', "", "Describe.", [&calls]() {
+            calls++;
+            throw std::runtime_error{"cannot open"};
+        }));
+        a.independent(a.add('u', "unknown", "Describe.", [&calls]() {
+            calls++;
+            throw 42;
+        }));
+        a.add('d', "", "Describe.", [&calls]() {
+            calls++;
+            throw std::logic_error{"dependent"};
+        });
+
+        // The first independent callback in argument order which throws is reported, once every callback has run.
+        std::vector<std::string> argv{"-x", "-y", "-e", "-u", "-x", "-y"};
+        auto error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::CallbackFailed);
+        assert(error.name == "e" && error.value == "cannot open");
+        assert(error.message() == "option 'e' failed: cannot open");
+        assert(calls == 6);
+
+        argv = {"-y", "--unknown", "-x"};
+        error = a.process(argv);
+        assert(error.name == "unknown" && error.value.empty());
+        assert(error.message() == "option 'unknown' failed");
+
+        // An exception thrown by another callback propagates, once the independent callbacks have finished.
+        calls = 0;
+        argv = {"-x", "-y", "-d", "-x", "-y"};
+        bool caught{};
+        try {
+            (void)a.process(argv);
+        } catch (const std::logic_error &) {
+            caught = true;
+        }
+        assert(caught && calls == 5);
+
+        // Tasks are passed to the executor; options remaining when it throws are dispatched on the calling thread.
+        size_t submitted{};
+        a.executor([&submitted](ArgParse::Callback<void()> task) {
+            if (submitted++) {
+                throw std::runtime_error{"full"};
+            }
+            task();
+        });
+        a.independent(a.add('z', "", "Describe.", count));
+        calls = 0;
+        argv = {"-x", "-y", "-z", "-x"};
+        assert(!a.process(argv));
+        assert(submitted == 2 && calls == 4);
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        ArgParse a;
+
+        // Occurrences of an independent option are dispatched one after another, so the last one wins.
+        int jobs{};
+        std::vector<int> seen;
+        auto j = a.add('j', "jobs", "N", "Describe.", jobs);
+        a.independent(j);
+        auto record = [&seen](const std::string &arg) { seen.push_back(std::stoi(arg)); };
+        a.independent(a.add('s', "", "N", "Describe.", record));
+        a.independent(a.add('q', "", "Describe.", []() {}));
+
+        for (int round = 0; round < 50; ++round) {
+            seen.clear();
+            std::vector<std::string> argv{"-j1", "-s1", "--jobs=2", "-q", "-s2", "-j3", "-s3", "-j4", "-q", "-s4"};
+            assert(!a.process(argv));
+            assert(jobs == 4);
+            assert(seen == (std::vector<int>{1, 2, 3, 4}));
+        }
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        ArgParse a;
+        a.add('v', "verbose", "Describe.", []() {});
+        a.add('O', "output", "FILE", "Describe.", [](const std::string &) {});
+        a.add('1', "", "Describe.", []() {});
+
+        std::vector<std::string> argv{"--verbsoe"};
+        auto error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::UnrecognizedOption);
+        assert(error.suggestion == "verbose");
+        assert(error.message() == "unrecognized option 'verbsoe'; did you mean 'verbose'?");
+
+        // The option character of the other case is suggested.
+        argv = {"-V"};
+        error = a.process(argv);
+        assert(error.message() == "unrecognized option 'V'; did you mean 'v'?");
+        argv = {"-o"};
+        error = a.process(argv);
+        assert(error.suggestion == "O");
+        argv = {"-x"};
+        error = a.process(argv);
+        assert(error.suggestion.empty());
+        assert(error.message() == "unrecognized option 'x'");
+
+        argv = {"--" + std::string(65, 'v')};
+        error = a.process(argv);
+        assert(error.kind == ArgParse::Error::Kind::UnrecognizedOption);
+        assert(error.suggestion.empty());
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Suggestions match those of a naive edit distance against every long name.
+        auto levenshtein = [](const std::string &a, const std::string &b) {
+            std::vector<size_t> row(b.size() + 1);
+            for (size_t j = 0; j <= b.size(); ++j) {
+                row[j] = j;
+            }
+            for (size_t i = 1; i <= a.size(); ++i) {
+                auto diagonal = row[0];
+                row[0] = i;
+                for (size_t j = 1; j <= b.size(); ++j) {
+                    auto above = row[j];
+                    row[j] = std::min({row[j] + 1, row[j - 1] + 1, diagonal + (a[i - 1] != b[j - 1])});
+                    diagonal = above;
+                }
+            }
+            return row[b.size()];
+        };
+
+        uint32_t seed{1};
+        auto random = [&seed](size_t n) {
+            seed = seed * 1103515245 + 12345;
+            return (seed >> 16) % n;
+        };
+        auto randomName = [&random](size_t maximum) {
+            std::string name;
+            for (auto n = 1 + random(maximum); n; --n) {
+                name += "abc-\xe9"[random(5)];
+            }
+            return name;
+        };
+
+        std::set<std::string> names;
+        while (names.size() < 300) {
+            names.insert(randomName(12));
+        }
+        ArgParse a;
+        for (const auto &name : names) {
+            a.add({}, name.c_str(), "Describe.", []() {});
+        }
+
+        size_t suggested{};
+        for (int i = 0; i < 2000; ++i) {
+            auto query = randomName(16);
+            if (std::any_of(names.begin(), names.end(), [&](const std::string &name) {
+                    return name.compare(0, query.size(), query) == 0;
+                })) {
+                continue;
+            }
+
+            auto limit = std::clamp<size_t>(query.size() / 3, 1, 3);
+            std::string expected;
+            for (const auto &name : names) {
+                if (auto d = levenshtein(query, name); d <= limit) {
+                    expected = name;
+                    limit = d - 1;
+                }
+            }
+
+            std::vector<std::string> argv{"--" + query};
+            auto error = a.process(argv);
+            assert(error.kind == ArgParse::Error::Kind::UnrecognizedOption);
+            assert(error.suggestion == expected);
+            suggested += expected.size() > 0;
+        }
+        assert(suggested > 100);
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        ArgParse a;
+        a.add('v', "verbose", "Be verbose.\nAt length.", []() {});
+        a.add('o', "output", "FILE", "Write to FILE.", [](const std::string &) {});
+        a.add({}, "output-format", "FORMAT", "Output format.", [](const std::string &) {});
+        a.add('x', "", "Describe x.", []() {});
+        a.addCommand("build", "Build targets.", [](ArgParse &command) {
+            command.add('j', "jobs", "N", "Parallel jobs.", [](const std::string &) {});
+            command.add('k', "keep-going", "Keep going.", []() {});
+        });
+        a.addCommand("bench", "Run benchmarks.", [](ArgParse &) {});
+
+        auto complete = [&a](std::vector<std::string> args, int index) {
+            args.insert(args.begin(), "program");
+            std::vector<char *> argv;
+            for (auto &arg : args) {
+                argv.push_back(arg.data());
+            }
+            std::ostringstream os;
+            a.complete(os, static_cast<int>(argv.size()), argv.data(), index);
+            return os.str();
+        };
+
+        // Long options are completed by prefix, with the first line of their description.
+        assert(complete({"--out"}, 1) == "--output\tWrite to FILE.\n--output-format\tOutput format.\n");
+        assert(complete({"--v"}, 1) == "--verbose\tBe verbose.\n");
+        assert(complete({"--z"}, 1).empty());
+        assert(complete({"-"}, 1) == "-o\tWrite to FILE.\n-v\tBe verbose.\n-x\tDescribe x.\n"
+                                     "--output\tWrite to FILE.\n--output-format\tOutput format.\n"
+                                     "--verbose\tBe verbose.\n");
+        assert(complete({"-v"}, 1) == "-v\tBe verbose.\n");
+        assert(complete({"-q"}, 1).empty());
+        assert(complete({"-vx"}, 1).empty());
+
+        // An option expecting an option-argument completes as its parameter name.
+        assert(complete({"-o"}, 2) == "\tFILE\n");
+        assert(complete({"-vo"}, 2) == "\tFILE\n");
+        assert(complete({"--output-f"}, 2) == "\tFORMAT\n");
+        assert(complete({"--output-format=j"}, 1) == "\tFORMAT\n");
+        assert(complete({"--verbose="}, 1).empty());
+        assert(complete({"-ofile"}, 2) == "build\tBuild targets.\nbench\tRun benchmarks.\n");
+        assert(complete({"-o", "file", "--v"}, 3) == "--verbose\tBe verbose.\n");
+        assert(complete({"--output-format", "json", "--no", "-v"}, 4) == "-v\tBe verbose.\n");
+
+        // Operands complete as commands, whose options complete the arguments following them.
+        assert(complete({}, 1) == "build\tBuild targets.\nbench\tRun benchmarks.\n");
+        assert(complete({"-v", "bu"}, 2) == "build\tBuild targets.\n");
+        assert(complete({"build", "--"}, 2) == "--jobs\tParallel jobs.\n--keep-going\tKeep going.\n");
+        assert(complete({"-v", "build", "-j"}, 4) == "\tN\n");
+        assert(complete({"build", "-v"}, 2).empty());
+        assert(complete({"install", "--"}, 2).empty());
+        assert(complete({"--", "-"}, 2).empty());
+        assert(complete({"--", "build", "--"}, 3).empty());
+
+        // An index outside the arguments, and past the new argument, has no completions.
+        assert(complete({"-"}, -1).empty());
+        assert(complete({"-"}, 3).empty());
+
+        ArgParse b;
+        b.add('v', "verbose", "Be verbose.", []() {});
+        std::vector<std::string> args{"program", "file", "-"};
+        std::vector<char *> argv{args[0].data(), args[1].data(), args[2].data()};
+        std::ostringstream os;
+        b.complete(os, 3, argv.data(), 2);
+        assert(os.str() == "-v\tBe verbose.\n--verbose\tBe verbose.\n");
+        os.str({});
+        b.complete(os, 3, argv.data(), 1);
+        assert(os.str().empty());
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Scripts name the program and a function derived from it.
+        for (auto shell : {ArgParse::Shell::Bash, ArgParse::Shell::Zsh, ArgParse::Shell::Fish}) {
+            std::ostringstream os;
+            ArgParse::completionScript(os, shell, "my-tool");
+            auto script = os.str();
+            assert(script.find("ARGPARSE_COMPLETE") != std::string::npos);
+            assert(script.find("_my_tool_argparse") != std::string::npos);
+            assert(script.find("@PROGRAM@") == std::string::npos && script.find("@FUNCTION@") == std::string::npos);
+        }
+
+        std::ostringstream os;
+        ArgParse::completionScript(os, ArgParse::Shell::Bash, "tool");
+        assert(os.str().find("complete -F _tool_argparse tool\n") != std::string::npos);
+        os.str({});
+        ArgParse::completionScript(os, ArgParse::Shell::Zsh, "tool");
+        assert(os.str().find("#compdef tool\n") == 0);
+        os.str({});
+        ArgParse::completionScript(os, ArgParse::Shell::Fish, "tool");
+        assert(os.str().find("complete -c tool -f -a '(_tool_argparse)'\n") != std::string::npos);
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        ArgParse a;
+
+        // Long names are found whatever order they are added in, including options added after a parse.
+        std::vector<std::string> trace;
+        for (auto name : {"zulu", "alpha", "mike", "alphabet"}) {
+            a.add({}, name, "Describe.", [&trace, name]() { trace.push_back(name); });
+        }
+        std::vector<std::string> argv{"--zu", "--alphab", "--m"};
+        assert(!a.process(argv));
+        assert((trace == std::vector<std::string>{"zulu", "alphabet", "mike"}));
+
+        a.add({}, "beta", "Describe.", [&trace]() { trace.push_back("beta"); });
+        trace.clear();
+        argv = {"--b", "--mike", "--z"};
+        assert(!a.process(argv));
+        assert((trace == std::vector<std::string>{"beta", "mike", "zulu"}));
+
+        argv = {"--alp"};
+        assert(a.process(argv).kind == ArgParse::Error::Kind::AmbiguousOption);
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Views bound to arguments which process removes from argv stay valid until the context's next parse.
+        std::string_view name;
+        std::vector<std::string_view> includes;
+        ArgParse a;
+        a.add({}, "name", "NAME", "Name.", name);
+        a.add('I', "", "DIR", "Include.", includes);
+
+        const std::string value(64, 'v');
+        const std::string dir = "/usr/local/include/" + std::string(48, 'd');
+        std::vector<std::string> argv{"--name", value, "-I", dir, "operand"};
+        assert(!a.process(argv));
+        assert((argv == std::vector<std::string>{"operand"}));
+        assert(name == value);
+        assert((includes == std::vector<std::string_view>{dir}));
+
+        ArgParse::Context context;
+        includes.clear();
+        argv = {"-I", dir, "x", "--name=" + value, "y"};
+        assert(!a.process(context, argv));
+        assert((argv == std::vector<std::string>{"x", "y"}));
+        assert(name == value);
+        assert((includes == std::vector<std::string_view>{dir}));
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // Operands read from a response file expanded by a command are returned.
+        ArgParse a;
+        bool keep{};
+        a.addCommand("build", "Build targets.", [&keep](ArgParse &cmd) {
+            cmd.expandResponseFiles();
+            cmd.add('k', "keep-going", "Keep going.", [&keep]() { keep = true; });
+        });
+
+        std::vector<std::string> argv{"build", "-k", "@" + temporaryFile("x y\n"), "z"};
+        assert(!a.process(argv));
+        assert(keep);
+        assert((argv == std::vector<std::string>{"x", "y", "z"}));
+    }
+
+    std::cout << "====" << std::endl;
+    {
+        // A concurrent dispatch holds its scratch in the context, so run on an executor it does not allocate.
+        alignas(std::max_align_t) static char buffer[64 * 1024];
+        std::pmr::monotonic_buffer_resource arena{buffer, sizeof(buffer), std::pmr::null_memory_resource()};
+
+        std::vector<char *> argv{const_cast<char *>("program"), const_cast<char *>("-xy"), const_cast<char *>("-zx"),
+                                 const_cast<char *>("operand")};
+        std::vector<std::string_view> operands;
+        operands.reserve(1);
+
+        size_t before = allocations;
+        {
+            ArgParse a{&arena};
+            int calls{};
+            for (auto c : {'x', 'y', 'z'}) {
+                a.independent(a.add(c, "", "Describe.", [&calls]() { calls++; }));
+            }
+            a.executor([](ArgParse::Callback<void()> task) { task(); });
+
+            ArgParse::Context context{&arena};
+            for (int round = 0; round < 2; ++round) {
+                assert(!a.process(context, static_cast<int>(argv.size()), argv.data(), operands));
+            }
+            assert(calls == 8);
+        }
+        assert(allocations == before);
+    }
+
+    for (const auto &path : temporaryFiles) {
+        unlink(path.c_str());
+    }
 }